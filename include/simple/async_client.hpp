@@ -0,0 +1,140 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_ASYNC_CLIENT_HPP
+#define SIMPLE_ASYNC_CLIENT_HPP
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "simple/request_pipeline.hpp"
+
+namespace simple {
+
+/**
+ * @class AsyncClient async_client.hpp.
+ * @brief The AsyncClient class creates a ZMQ socket of type ZMQ_DEALER that sends requests to a Server without
+ * waiting for the replies of the previous ones.
+ * @tparam T The simple_msgs type to use.
+ *
+ * Unlike a Client, which waits for the reply to each request before sending the next one, an AsyncClient keeps any
+ * number of requests in flight on the same connection and matches the replies to their requests through a request id,
+ * so they can arrive in any order. The requests rate is not bound by the round trip time anymore. Any Server works
+ * with an AsyncClient. A dedicated I/O thread sends the requests and receives the replies.
+ * A request that cannot be queued for sending, e.g. while the Server is down and the ZMQ send queue (1000 messages by
+ * default) is full, fails right away instead of blocking the I/O thread.
+ */
+template <typename T>
+class AsyncClient {
+public:
+  AsyncClient() = default;
+
+  /**
+   * @brief Creates a ZMQ_DEALER socket and connects it to the given address.
+   * @param [in] address - address the client connects to, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>. e.g
+   * tcp://localhost:5555.
+   * @param [in] timeout - Time, in msec, a request waits for its reply.
+   * @param [in] linger - Time, in msec, unsent messages linger in memory after socket is closed. Default -1 (infinite).
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit AsyncClient(const std::string& address, int timeout = 2000, int linger = -1, const std::string& context = "")
+    : pipeline_{new RequestPipeline{address, T::getTopic(), timeout, linger, context}} {}
+
+  // Copy operations are not available.
+  AsyncClient(const AsyncClient& other) = delete;
+  AsyncClient& operator=(const AsyncClient& other) = delete;
+
+  /**
+   * @brief Move constructor.
+   */
+  AsyncClient(AsyncClient&& other) = default;
+
+  /**
+   * @brief Move assignment operator.
+   */
+  AsyncClient& operator=(AsyncClient&& other) = default;
+
+  /**
+   * @brief The requests still in flight fail.
+   */
+  ~AsyncClient() = default;
+
+  /**
+   * @brief Sends the request to a server without waiting for its reply.
+   * @param [in] msg - the request.
+   * @return a future holding the reply. It holds a std::runtime_error if no reply was received in time.
+   */
+  std::future<T> requestAsync(const T& msg) {
+    auto promise = std::make_shared<std::promise<T>>();
+    auto future = promise->get_future();
+    requestAsync(msg, [promise](bool success, T& reply) {
+      if (success) {
+        promise->set_value(std::move(reply));
+      } else {
+        promise->set_exception(
+            std::make_exception_ptr(std::runtime_error("[SIMPLE Client] - No reply received for this request.")));
+      }
+    });
+    return future;
+  }
+
+  /**
+   * @brief Sends the request to a server without waiting for its reply.
+   * @param [in] msg - the request.
+   * @param [in] callback - called with true and the reply once it is received, or with false if no reply was received
+   * in time. It runs on the I/O thread of the AsyncClient, it should return quickly.
+   */
+  void requestAsync(const T& msg, const std::function<void(bool, T&)>& callback) {
+    if (pipeline_ == nullptr) {
+      T reply{};
+      callback(false, reply);
+      return;
+    }
+    pipeline_->submit(std::unique_ptr<RequestPipeline::Request>{new Request{msg, callback}});
+  }
+
+  /**
+   * @brief Query the endpoint that this object is bound to.
+   *
+   * Can be used to find the bound port if binding to ephemeral ports.
+   * @return the endpoint in form of a ZMQ DSN string, i.e. "tcp://0.0.0.0:8000". Empty for a default constructed or
+   * moved-from AsyncClient.
+   */
+  const std::string& endpoint() {
+    static const std::string no_endpoint{};
+    return pipeline_ != nullptr ? pipeline_->endpoint() : no_endpoint;
+  }
+
+private:
+  /**
+   * @brief A request of type T and the callback waiting for its reply.
+   */
+  class Request : public RequestPipeline::Request {
+  public:
+    Request(const T& msg, const std::function<void(bool, T&)>& callback) : message_{msg}, callback_{callback} {}
+
+    const simple_msgs::GenericMessage& message() const override { return message_; }
+    simple_msgs::GenericMessage& reply() override { return reply_; }
+    void complete(bool success) override { callback_(success, reply_); }
+
+  private:
+    T message_{};                             //! The request.
+    T reply_{};                               //! The reply, once received.
+    std::function<void(bool, T&)> callback_;  //! Called with the reply.
+  };
+
+  std::unique_ptr<RequestPipeline> pipeline_{nullptr};  //! Sends the requests and receives the replies.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_ASYNC_CLIENT_HPP
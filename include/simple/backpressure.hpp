@@ -0,0 +1,27 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_BACKPRESSURE_HPP
+#define SIMPLE_BACKPRESSURE_HPP
+
+namespace simple {
+
+/**
+ * @brief What happens to a message that does not fit in a full queue, e.g. when a slow Subscriber attaches to a fast
+ * Publisher.
+ */
+enum class BackpressurePolicy : int {
+  block = 0,        //! The sender waits until the queue has room for the message, nothing is dropped.
+  drop_newest = 1,  //! The new message is dropped, as a ZMQ socket does when it reaches its high water mark.
+  drop_oldest = 2   //! The oldest queued messages are dropped in favour of the new one, i.e. the queue is conflated.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_BACKPRESSURE_HPP
@@ -11,10 +11,16 @@
 #ifndef SIMPLE_CLIENT_HPP
 #define SIMPLE_CLIENT_HPP
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "simple/generic_socket.hpp"
+#include "simple/poller.hpp"
 
 namespace simple {
 
@@ -26,6 +32,11 @@ namespace simple {
  *
  * Implements the logic for a Client in the Client / Server paradigm.
  * A Client can send requests to a Server using messages of types T and receive back an answer.
+ * A request that is not answered in time does not affect the next ones: the connection is kept and the late reply is
+ * dropped.
+ * A Client connected to several replicas of a Server spreads its requests among the reachable ones, and resends a
+ * request as soon as the connection to a replica is lost. With hedging, see setHedging(), a request that is slower than
+ * most of the previous ones is also sent to a second replica, and the first reply is taken.
  */
 template <typename T>
 class Client {
@@ -38,9 +49,34 @@ public:
    * tcp://localhost:5555.
    * @param [in] timeout - Time, in msec, the client shall wait for a reply. Default 30 seconds.
    * @param [in] linger - Time, in msec, unsent messages linger in memory after socket is closed. Default -1 (infinite).
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
    */
-  explicit Client(const std::string& address, int timeout = 2000, int linger = -1)
-    : socket_{zmq_socket_type::req, T::getTopic()}, address_{address}, timeout_{timeout}, linger_{linger} {
+  explicit Client(const std::string& address, int timeout = 2000, int linger = -1, const std::string& context = "")
+    : socket_{zmq_socket_type::req, T::getTopic(), context}, addresses_{address}, timeout_{timeout}, linger_{linger} {
+    initClient();
+  }
+
+  /**
+   * @brief Creates a ZMQ_REQ socket and connects it to all the given replicas of a Server.
+   *
+   * The requests are sent to the replicas in turn, skipping the ones that are not reachable. A replica that does not
+   * answer the heartbeats is disconnected, and the request waiting for it is sent again to another replica: the
+   * callback of the Server may then handle a request twice.
+   * @param [in] addresses - addresses of the replicas, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>. e.g
+   * tcp://localhost:5555.
+   * @param [in] timeout - Time, in msec, the client shall wait for a reply, failovers included. Default 2 seconds.
+   * @param [in] linger - Time, in msec, unsent messages linger in memory after socket is closed. Default -1 (infinite).
+   * @param [in] heartbeat_interval - Time, in msec, between two heartbeats. A replica is considered lost after three
+   * heartbeats without an answer.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit Client(const std::vector<std::string>& addresses, int timeout = 2000, int linger = -1,
+                  int heartbeat_interval = 1000, const std::string& context = "")
+    : socket_{zmq_socket_type::req, T::getTopic(), context}
+    , addresses_{addresses}
+    , timeout_{timeout}
+    , linger_{linger}
+    , heartbeat_interval_{heartbeat_interval} {
     initClient();
   }
 
@@ -64,23 +100,107 @@ public:
    * @brief Sends the request to a server and waits for an answer.
    * @param [in,out] msg - simple_msgs class wrapper for Flatbuffer messages..
    */
-  bool request(T& msg) {
+  bool request(T& msg) { return request(msg, timeout_); }
+
+  /**
+   * @brief Sends the request to a server and waits for an answer up to the given time.
+   * @param [in,out] msg - simple_msgs class wrapper for Flatbuffer messages.
+   * @param [in] timeout - Time, in msec, to wait for the reply to this request.
+   */
+  bool request(T& msg, int timeout) {
+    if (hedging_) { return requestWithHedging(msg, timeout); }
+    if (addresses_.size() > 1) { return requestWithFailover(msg, timeout); }
     bool success{false};
 
+    if (timeout != socket_timeout_) {
+      socket_.setTimeout(timeout);
+      socket_timeout_ = timeout;
+    }
+
     // Send the message to the Server and receive back the response.
     if (socket_.sendMsg(msg, "[SIMPLE Client] - ")) {
       if (socket_.receiveMsg(msg, "[SIMPLE Client] - ")) {
         success = true;
       } else {
+        // The socket is relaxed, the next request can be sent on the same connection.
         std::cerr << "[SIMPLE Client] - No reply received. Aborting this request." << std::endl;
-        // If no message was received back we need to delete the existing socket and create a new one.
-        socket_.closeSocket();
-        initClient();
       }
     }
     return success;
   }
 
+  /**
+   * @brief Sends a request again to another replica when its reply takes longer than the given percentile of the
+   * latencies of the last requests, the first reply is taken and the late one is dropped.
+   * @param [in] percentile - the percentile of the recent latencies after which a request is hedged, e.g. 95.
+   * @param [in] window - number of recent requests whose latency is considered.
+   * @throws std::runtime_error if the Client is not connected to several replicas, the percentile is not in (0, 100]
+   * or setMonitor() was called before.
+   *
+   * Requests are not hedged until the latencies of some requests have been measured, hedged requests are not measured.
+   * A hedged request is handled by two replicas: while the replicas answer as usual, about 100 - percentile % of the
+   * requests are hedged, while a replica stalls most of the requests routed to it are.
+   * Enabling hedging replaces the socket of the Client, a monitor has to be set afterwards.
+   */
+  void setHedging(double percentile = 95.0, size_t window = 100) {
+    if (addresses_.size() < 2) {
+      throw std::runtime_error("[SIMPLE Error] - Hedging needs a Client connected to several replicas of a Server.");
+    }
+    if (percentile <= 0 || percentile > 100) {
+      throw std::runtime_error("[SIMPLE Error] - The hedging percentile has to be in (0, 100].");
+    }
+    if (!hedging_ && monitored_) {
+      throw std::runtime_error("[SIMPLE Error] - Hedging has to be enabled before setting a monitor.");
+    }
+    hedging_percentile_ = percentile;
+    latencies_.assign(std::max<size_t>(window, 1), std::chrono::microseconds{0});
+    num_latencies_ = 0;
+
+    // The replies are matched to their request by id, which a ZMQ_REQ socket does not allow.
+    if (!hedging_) {
+      hedging_ = true;
+      socket_.closeSocket();
+      initClient();
+    }
+  }
+
+  /**
+   * @brief Returns the delay after which a request is hedged, the request timeout while it is not known yet.
+   */
+  std::chrono::microseconds hedgingDelay() const {
+    if (!hedging_ || num_latencies_ < std::min(min_hedging_samples, latencies_.size())) {
+      return std::chrono::milliseconds(timeout_);
+    }
+    std::vector<std::chrono::microseconds> latencies(latencies_.begin(),
+                                                     latencies_.begin() + std::min(num_latencies_, latencies_.size()));
+    auto rank = static_cast<size_t>(std::ceil(hedging_percentile_ / 100 * latencies.size()));
+    auto percentile = latencies.begin() + (std::max<size_t>(rank, 1) - 1);
+    std::nth_element(latencies.begin(), percentile, latencies.end());
+    return *percentile;
+  }
+
+  /**
+   * @brief Returns how many requests have been sent to a second replica.
+   */
+  uint64_t hedgedRequests() const { return hedged_requests_; }
+
+  /**
+   * @brief Reports the connection events of the Client, e.g. the loss of its Server, to the given callback.
+   * @param [in] callback - called on a dedicated thread with every SocketEvent and the endpoint it refers to.
+   * @throws std::runtime_error if ZMQ cannot monitor the socket.
+   *
+   * The events that happened before, e.g. the first connection, are not reported. See setHedging().
+   */
+  void setMonitor(const SocketEventCallback& callback) {
+    socket_.setMonitor(callback, "[SIMPLE Client] - ");
+    monitored_ = true;
+  }
+
+  /**
+   * @brief Returns how many times the given SocketEvent happened since setMonitor() was called.
+   */
+  uint64_t eventCount(const SocketEvent& event) const { return socket_.eventCount(event); }
+
   /**
    * @brief Query the endpoint that this object is bound to.
    *
@@ -92,17 +212,140 @@ public:
 private:
   // Initialize the client, setting up the socket and its configuration.
   void initClient() {
-    if (!socket_.isSocketValid()) { socket_.initSocket(zmq_socket_type::req); }
+    if (!socket_.isSocketValid()) { socket_.initSocket(hedging_ ? zmq_socket_type::dealer : zmq_socket_type::req); }
     socket_.setTimeout(timeout_);
     socket_.setLinger(linger_);
-    socket_.connect(address_);
+    if (!hedging_) { socket_.setRelaxed(); }
+    if (addresses_.size() > 1) {
+      socket_.setFailover(heartbeat_interval_, timeout_);
+      socket_.setMonitor(nullptr, "[SIMPLE Client] - ");  //! The lost connections are counted.
+    }
+    for (const auto& address : addresses_) { socket_.connect(address); }
+    socket_timeout_ = timeout_;
+  }
+
+  /**
+   * @brief Sends the request to a replica and waits for its answer. The request is sent again whenever a connection
+   * is lost meanwhile, ZMQ routes it to one of the replicas that are still connected.
+   */
+  bool requestWithFailover(T& msg, int timeout) {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout);
+
+    if (timeout != socket_timeout_) {
+      socket_.setTimeout(timeout);
+      socket_timeout_ = timeout;
+    }
+
+    auto disconnections = socket_.eventCount(SocketEvent::disconnected);
+    if (!socket_.sendMsg(msg, "[SIMPLE Client] - ")) { return false; }
+
+    std::vector<PollItem> items(1);
+    items.front().socket = socket_.nativeHandle();
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now());
+    while (remaining.count() > 0) {
+      // The connections are checked between short polls of the socket.
+      if (poll(items, std::min(remaining, failover_check_interval)) != 0) {
+        if (socket_.receiveMsg(msg, "[SIMPLE Client] - ")) { return true; }
+        break;
+      }
+      auto current_disconnections = socket_.eventCount(SocketEvent::disconnected);
+      if (current_disconnections != disconnections) {
+        disconnections = current_disconnections;
+        if (!socket_.sendMsg(msg, "[SIMPLE Client] - ")) { return false; }
+      }
+      remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now());
+    }
+    std::cerr << "[SIMPLE Client] - No reply received. Aborting this request." << std::endl;
+    return false;
   }
 
-  GenericSocket socket_{};   //! The internal socket.
-  std::string address_{""};  //! The address the Client is connected to.
-  int timeout_{30000};       //! Milliseconds the Client should wait for a reply from a Server.
-  int linger_{-1};           //! Milliseconds the messages linger in memory after the socket is closed.
+  /**
+   * @brief Sends the request with an id and waits for the reply with the same id. The request is sent again to another
+   * replica once the hedging delay has passed, and whenever a connection is lost meanwhile.
+   */
+  bool requestWithHedging(T& msg, int timeout) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::milliseconds(timeout);
+    const auto hedging_deadline = start + hedgingDelay();
+    const auto request_id = next_request_id_++;
+    bool hedged{false};
+
+    auto disconnections = socket_.eventCount(SocketEvent::disconnected);
+    if (!socket_.sendMsg(msg, request_id, "[SIMPLE Client] - ")) { return false; }
+
+    std::vector<PollItem> items(1);
+    items.front().socket = socket_.nativeHandle();
+    auto now = Clock::now();
+    while (now < deadline) {
+      // The connections are checked between short polls of the socket, the hedging delay ends a poll as well.
+      auto wait = std::chrono::duration_cast<std::chrono::microseconds>((hedged ? deadline : hedging_deadline) - now);
+      wait = std::max(std::chrono::microseconds{0}, std::min(wait, failover_check_interval));
+      if (poll(items, wait) != 0) {
+        uint64_t reply_id{0};
+        if (socket_.receiveRequestId(reply_id, "[SIMPLE Client] - ")) {
+          if (reply_id == request_id) {
+            if (!socket_.receiveMsg(msg, "[SIMPLE Client] - ")) { return false; }
+            // The latency of a hedged request depends on the delay itself, only the others are measured.
+            if (!hedged) { addLatency(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start)); }
+            return true;
+          }
+          socket_.discardMsg();  //! The late reply to a previous request.
+        }
+      }
+
+      now = Clock::now();
+      auto current_disconnections = socket_.eventCount(SocketEvent::disconnected);
+      bool resend{current_disconnections != disconnections};
+      disconnections = current_disconnections;
+      if (!hedged && now >= hedging_deadline && now < deadline) {
+        // ZMQ sends to the connected replicas in turn, the same request goes to another replica.
+        hedged = true;
+        ++hedged_requests_;
+        resend = true;
+      }
+      if (resend && !socket_.sendMsg(msg, request_id, "[SIMPLE Client] - ")) { return false; }
+    }
+    std::cerr << "[SIMPLE Client] - No reply received. Aborting this request." << std::endl;
+    return false;
+  }
+
+  /**
+   * @brief Records the latency of an answered request, replacing the oldest one.
+   */
+  void addLatency(std::chrono::microseconds latency) {
+    latencies_[num_latencies_ % latencies_.size()] = latency;
+    ++num_latencies_;
+  }
+
+  //! Number of latencies to measure before hedging, unless the window is smaller.
+  static constexpr size_t min_hedging_samples{10};
+
+  //! How often a Client connected to several replicas checks for lost connections while waiting for a reply.
+  static constexpr std::chrono::microseconds failover_check_interval{10000};
+
+  GenericSocket socket_{};                //! The internal socket.
+  std::vector<std::string> addresses_{};  //! The addresses the Client is connected to.
+  int timeout_{30000};                    //! Milliseconds the Client should wait for a reply from a Server.
+  int socket_timeout_{-1};                //! The timeout currently set on the socket.
+  int linger_{-1};                        //! Milliseconds the messages linger in memory after the socket is closed.
+  int heartbeat_interval_{1000};          //! Milliseconds between two heartbeats, with several replicas.
+  bool monitored_{false};                 //! Whether the user set a monitor.
+
+  // Hedging, see setHedging().
+  bool hedging_{false};                                 //! Whether the requests are hedged.
+  double hedging_percentile_{95.0};                     //! Percentile of the latencies after which a request is hedged.
+  std::vector<std::chrono::microseconds> latencies_{};  //! Latencies of the last answered requests, circularly.
+  size_t num_latencies_{0};                             //! Number of latencies recorded so far.
+  uint64_t next_request_id_{0};                         //! Id of the next hedged request.
+  uint64_t hedged_requests_{0};                         //! Number of requests sent to a second replica.
 };
+
+template <typename T>
+constexpr size_t Client<T>::min_hedging_samples;
+template <typename T>
+constexpr std::chrono::microseconds Client<T>::failover_check_interval;
 }  // Namespace simple.
 
 #endif  // SIMPLE_CLIENT_HPP
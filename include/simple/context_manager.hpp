@@ -11,8 +11,11 @@
 #ifndef SIMPLE_CONTEXT_MANAGER_HPP
 #define SIMPLE_CONTEXT_MANAGER_HPP
 
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "simple_export.h"
 
@@ -22,6 +25,29 @@ class context_t;
 }
 
 namespace simple {
+/**
+ * @brief Configuration of a ZMQ context, it has to be set before the context is used for the first time.
+ *
+ * A value of -1 keeps the ZMQ default. Any option of the default context that is not set explicitly through
+ * ContextManager::configure() is read from the environment, if available: SIMPLE_IO_THREADS,
+ * SIMPLE_IO_THREAD_AFFINITY (comma separated list of CPUs, e.g. "2,3"), SIMPLE_THREAD_PRIORITY,
+ * SIMPLE_THREAD_SCHED_POLICY, SIMPLE_MAX_SOCKETS and SIMPLE_TYPE_OF_SERVICE.
+ */
+struct ContextOptions {
+  int io_threads{-1};                     //! Number of ZMQ I/O threads. The ZMQ default is 1.
+  std::vector<int> io_thread_affinity{};  //! CPUs the ZMQ I/O threads are pinned to. Empty for any CPU.
+  int thread_priority{-1};                //! Scheduling priority of the ZMQ I/O threads.
+  int thread_sched_policy{-1};            //! Scheduling policy of the ZMQ I/O threads, e.g. SCHED_FIFO.
+  int max_sockets{-1};                    //! Maximum number of sockets. The ZMQ default is 1023.
+  int type_of_service{-1};                //! IP ToS field of the packets sent by the sockets, e.g. 0xb8 (DSCP EF).
+
+  /**
+   * @brief Returns the options set in the environment.
+   * @throws std::runtime_error if a variable does not hold a valid value.
+   */
+  static ContextOptions fromEnvironment();
+};
+
 /**
  * @class ContextManager context_manager.hpp.
  * @brief The ContextManager handles a singleton ZMQ Context that is shared between GenericSocket objects.
@@ -30,6 +56,13 @@ namespace simple {
  * Context, since it is not recommended to create more than one context in that case.
  * A ContextManager cannot be instantiated, a ContextManager object can only access the internal instance of the ZMQ
  * Context.
+ * The number of I/O threads, their CPU affinity and priority can be configured before the context is first used, so
+ * that heavy streams can be spread over several cores.
+ *
+ * Besides the default context, any number of named contexts can be used. Each one has its own I/O threads and queues,
+ * e.g. a "control" context for the commands of a control loop and a "bulk" context for image streams, so that the
+ * control messages do not wait behind the bulk transfers. Every Publisher, Subscriber, Client and Server can be given
+ * the name of its context at construction. Sockets in different contexts cannot communicate through inproc.
  */
 class ContextManager {
 public:
@@ -47,8 +80,20 @@ public:
    * That instantiation performs thread-safe operations to create/dispose the underlying ZMQ context object.
    */
   static zmq::context_t* instance();
+
+  /**
+   * @brief Returns the ZMQ context with the given name, it is created during the first call.
+   * @param [in] name - the name of the context, the default context if empty.
+   */
+  static zmq::context_t* instance(const std::string& name);
+
   /**
-   * @brief Destroys the current instance of the ZMQ context.
+   * @brief Returns the IP type of service set for the sockets of the given context, -1 if not set.
+   */
+  static int typeOfService(const std::string& name);
+
+  /**
+   * @brief Destroys the current instances of the ZMQ contexts, the default one and the named ones.
    *
    * It is sometimes required to control the lifetime of the zmq context object explicitly, most notably
    * when using simple as (or from a) dynamic library. In such a case, the context needs to be destroyed
@@ -59,9 +104,31 @@ public:
    */
   static void destroy();
 
+  /**
+   * @brief Sets the options of the ZMQ context, they are applied when the context is created.
+   * @param [in] options - the context options. Any option left to its default is read from the environment.
+   * @throws std::runtime_error if the context is already in use.
+   */
+  static void configure(const ContextOptions& options);
+
+  /**
+   * @brief Sets the options of the named ZMQ context, they are applied when the context is created.
+   * @param [in] name - the name of the context, the default context if empty.
+   * @param [in] options - the context options.
+   * @throws std::runtime_error if the context is already in use.
+   */
+  static void configure(const std::string& name, const ContextOptions& options);
+
 private:
+  /**
+   * @brief Applies the options to a newly created context.
+   */
+  static void applyOptions(zmq::context_t& context, const ContextOptions& options);
+
   static SIMPLE_EXPORT std::mutex context_mutex_;
   static SIMPLE_EXPORT std::shared_ptr<zmq::context_t> context_;  //! zmq::context_t is automatically disposed.
+  static SIMPLE_EXPORT std::map<std::string, std::shared_ptr<zmq::context_t>> named_contexts_;  //! By name.
+  static SIMPLE_EXPORT std::map<std::string, ContextOptions> options_;  //! The options of every context, by name.
 };
 }  // Namespace simple.
 
@@ -0,0 +1,89 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_EXECUTOR_HPP
+#define SIMPLE_EXECUTOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simple/generic_socket.hpp"
+
+namespace simple {
+
+// Forward declaration.
+class ExecutorThread;
+
+/**
+ * @class Executor executor.hpp.
+ * @brief An Executor receives the messages of any number of Subscribers and Servers on a fixed number of threads.
+ *
+ * Without an Executor, every Subscriber and Server runs its own thread. Those given an Executor on construction are
+ * registered to one of its threads instead, which waits on all of its sockets at once through zmq_poll and runs the
+ * callbacks of the sockets that received a message. The number of threads does not grow with the number of
+ * Subscribers and Servers. Callbacks registered to the same thread run one at a time, a slow callback delays the
+ * others. The Executor has to outlive the Subscribers and Servers that use it.
+ */
+class Executor {
+public:
+  /**
+   * @brief Creates an Executor and starts the given number of threads.
+   * @param [in] num_threads - the number of polling threads.
+   * @param [in] context - name of the ZMQ context of the sockets waking the threads up, see ContextManager. The default
+   * context if empty. It should be the context of the Subscribers and Servers using the Executor, so that no other
+   * context is created.
+   */
+  explicit Executor(size_t num_threads = 1, const std::string& context = "");
+
+  /**
+   * @brief Stops the threads of the Executor. No callback runs afterwards.
+   */
+  ~Executor();
+
+  // An Executor cannot be copied nor moved, Subscribers and Servers keep a reference to it.
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  /**
+   * @brief Returns the number of threads of the Executor.
+   */
+  inline size_t numThreads() const { return threads_.size(); }
+
+  // Friend declarations. Every Server<T> and Subscriber<T> is a friend.
+  template <typename T>
+  friend class Server;
+  template <typename T>
+  friend class Subscriber;
+
+protected:
+  /**
+   * @brief Registers the given socket. The handler is called on a thread of the Executor every time the socket has a
+   * message to receive, it has to receive it.
+   * @return an identifier of the registration, to pass to remove().
+   */
+  size_t add(const std::shared_ptr<GenericSocket>& socket, const std::function<void()>& handler);
+
+  /**
+   * @brief Unregisters a socket. Once it returns the handler is not running anymore and it is not called again, unless
+   * it is called by the handler itself.
+   */
+  void remove(size_t id);
+
+private:
+  std::vector<std::unique_ptr<ExecutorThread>> threads_{};  //! The threads polling the sockets.
+  std::atomic<size_t> next_id_{0};                          //! Identifier of the next registration.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_EXECUTOR_HPP
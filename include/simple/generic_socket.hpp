@@ -11,14 +11,21 @@
 #ifndef SIMPLE_GENERIC_SOCKET_HPP
 #define SIMPLE_GENERIC_SOCKET_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <simple_msgs/generic_message.hpp>
 #include <string>
+#include <vector>
 
+#include "backpressure.hpp"
 #include "context_manager.hpp"
+#include "socket_monitor.hpp"
 
 namespace flatbuffers {
 class DetachedBuffer;
@@ -30,10 +37,27 @@ class socket_t;
 
 namespace simple {
 
+// Forward declarations.
+class AsyncSender;
+class BuilderPool;
+class SharedMemoryPool;
+class SharedMemoryReader;
+struct OutgoingMessage;
+struct ReceivedBatch;
+
 /**
  * @brief The zmq::socket_type are redefined locally to avoid including the zmq.hpp header in simple headers.
  */
-enum class zmq_socket_type : int { pub = 1, sub = 2, req = 3, rep = 4 };
+enum class zmq_socket_type : int { pub = 1, sub = 2, req = 3, rep = 4, dealer = 5, router = 6, xpub = 9 };
+
+/**
+ * @brief How the bulk data of a message (see simple_msgs::Payload), e.g. the pixels of an Image, is transmitted.
+ */
+enum class PayloadTransport : int {
+  flatbuffer = 0,     //! Serialized within the Flatbuffers buffer of the message.
+  shared_memory = 1,  //! Written to a POSIX shared memory slot, only its descriptor is sent. Same host only.
+  zmq_frame = 2       //! Sent as a separate ZMQ frame after the message, owned data is not copied.
+};
 
 /**
  * @class GenericSocket generic_socket.hpp.
@@ -59,7 +83,8 @@ public:
    */
   GenericSocket& operator=(GenericSocket&& other) noexcept;
 
-  // Friend declarations. Every Client<T>, Server<T>, Publisher<T> and Subscriber<T> is a friend.
+  // Friend declarations. Every Client<T>, Server<T>, Publisher<T> and Subscriber<T> is a friend, as well as the
+  // threads of an Executor and the I/O thread of an AsyncClient.
   template <typename T>
   friend class Client;
   template <typename T>
@@ -68,6 +93,9 @@ public:
   friend class Publisher;
   template <typename T>
   friend class Subscriber;
+  friend class ExecutorThread;
+  friend class ReplyRouter;
+  friend class RequestPipeline;
 
 protected:
   // Class ctors are protected. A user cannot instantiate a GenericSocket.
@@ -77,14 +105,18 @@ protected:
    * @brief Constructs a socket with the given ZMQ socket type.
    * @param [in] type - the ZMQ type.
    * @param [in] topic - the message topic, it is internally defined for every simple_msgs.
+   * @param [in] context - the name of the ZMQ context of the socket, see ContextManager. The default context if empty.
    *
    * Accepted types are:
    * ZMQ_PUB - for a Publisher.
    * ZMQ_SUB - for a Subscriber.
    * ZMQ_REQ - for a Client.
    * ZMQ_REP - for a Server.
+   * ZMQ_DEALER - for an AsyncClient.
+   * ZMQ_ROUTER - for a Server with deferred replies.
+   * ZMQ_XPUB - for a Publisher.
    */
-  explicit GenericSocket(const zmq_socket_type& type, const std::string& topic);
+  explicit GenericSocket(const zmq_socket_type& type, const std::string& topic, const std::string& context = "");
 
   /**
    * @brief Binds the ZMQ Socket to the given address.
@@ -105,9 +137,44 @@ protected:
    * @param [in] message - simple_msgs class wrapper for Flatbuffer messages.
    * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
    * @return success or failure in sending the message over ZMQ.
+   *
+   * A ZMQ_XPUB socket without subscribers would drop the message, it is not even serialized. See subscriberCount().
    */
   bool sendMsg(const simple_msgs::GenericMessage& message, const std::string& custom_error = "[SIMPLE Error] - ") const;
 
+  /**
+   * @brief Sends buffer data over the ZMQ Socket, preceded by a request envelope: the given request id and an empty
+   * delimiter frame. A ZMQ_REP socket sends the envelope back with its reply.
+   * @param [in] message - simple_msgs class wrapper for Flatbuffer messages.
+   * @param [in] request_id - identifies the reply to this request.
+   * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
+   * @return success or failure in sending the message over ZMQ.
+   */
+  bool sendMsg(const simple_msgs::GenericMessage& message, uint64_t request_id, const std::string& custom_error) const;
+
+  /**
+   * @brief Sends buffer data over a ZMQ_ROUTER socket, preceded by the routing envelope of the request it replies to
+   * and an empty delimiter frame.
+   * @param [in] message - simple_msgs class wrapper for Flatbuffer messages.
+   * @param [in] envelope - the envelope received with the request, see receiveEnvelope().
+   * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
+   * @return success or failure in sending the message over ZMQ.
+   */
+  bool sendMsg(const simple_msgs::GenericMessage& message, const std::vector<std::string>& envelope,
+               const std::string& custom_error) const;
+
+  /**
+   * @brief Sends the given messages as a single batch: one topic frame, one frame holding all the serialized messages
+   * and one frame describing where each of them is. The payloads are serialized within the messages.
+   * @param [in] messages - the messages to send, in order. Nothing is sent if it is empty.
+   * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
+   * @return success or failure in sending the batch over ZMQ.
+   *
+   * receiveMsg() unpacks a received batch and returns its messages one at a time.
+   */
+  bool sendBatch(const std::vector<const simple_msgs::GenericMessage*>& messages,
+                 const std::string& custom_error = "[SIMPLE Error] - ") const;
+
   /**
    * @brief Receive a message of type T from the ZMQ Socket.
    * @param [in,out] msg - The message of type T to populate with the data incoming from the ZMQ Socket.
@@ -116,13 +183,55 @@ protected:
    */
   bool receiveMsg(simple_msgs::GenericMessage& msg, const std::string& custom_error = "");
 
+  /**
+   * @brief Receives the envelope of a reply sent back to sendMsg() with a request id. The message itself follows, it
+   * is received with receiveMsg() or dropped with discardMsg().
+   * @param [out] request_id - the request id found in the envelope.
+   * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
+   * @return false if no envelope was received, the whole message is discarded.
+   */
+  bool receiveRequestId(uint64_t& request_id, const std::string& custom_error = "");
+
+  /**
+   * @brief Receives the routing envelope of a request received by a ZMQ_ROUTER socket: the identity of the peer and
+   * the frames the peer sent before the empty delimiter, e.g. a request id. The request itself follows, it is received
+   * with receiveMsg().
+   * @param [out] envelope - the frames of the envelope, without the delimiter.
+   * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
+   * @return false if no envelope was received, the whole message is discarded.
+   */
+  bool receiveEnvelope(std::vector<std::string>& envelope, const std::string& custom_error = "");
+
+  /**
+   * @brief Receives and discards the rest of a message, e.g. a reply whose request is not waiting for it anymore.
+   */
+  void discardMsg();
+
   /**
    * @brief Set the ZMQ socket to accept only messages with the correct topic name.
    *
-   * The topic name is set to the one privded by the template argument of this socket.
+   * The topic name is set to the one privded by the template argument of this socket. The welcome message of the
+   * Publisher is accepted as well, see isWelcomed().
    */
   void filter();
 
+  /**
+   * @brief Set a ZMQ_REQ socket to accept a new request while the reply to the previous one is still missing, the late
+   * reply is then dropped. The connection is kept after a timeout.
+   */
+  void setRelaxed();
+
+  /**
+   * @brief Prepares a socket connecting to several peers to fail over among them. It has to be called before
+   * connecting.
+   * @param [in] heartbeat_interval - a ZMTP heartbeat is sent every interval, in milliseconds. A peer that does not
+   * answer within three intervals is disconnected.
+   * @param [in] send_timeout - maximum time to wait for a connected peer when sending, in milliseconds.
+   *
+   * Messages are only queued for completed connections, never for a peer that is not reachable.
+   */
+  void setFailover(int heartbeat_interval, int send_timeout);
+
   /**
    * @brief Set the timeout of the ZMQ socket.
    * @param [in] timeout - in milliseconds.
@@ -132,6 +241,12 @@ protected:
    */
   void setTimeout(int timeout);
 
+  /**
+   * @brief Set the send timeout of the ZMQ socket.
+   * @param [in] timeout - in milliseconds. 0 fails a message that cannot be queued right away, -1 waits forever.
+   */
+  void setSendTimeout(int timeout);
+
   /**
    * @brief Set the linger time of the ZMQ socket.
    * @param [in] linger - in milliseconds.
@@ -141,7 +256,125 @@ protected:
   void setLinger(int linger);
 
   /**
-   * @brief Initialize the ZMQ socket given its type.
+   * @brief Set the high water marks of the ZMQ socket, the maximum number of messages queued for each peer.
+   * @param [in] send - for the outgoing messages.
+   * @param [in] receive - for the incoming messages.
+   *
+   * With ZMQ older than 4.2.3 they only apply to the connections established afterwards.
+   */
+  void setHighWaterMark(int send, int receive);
+
+  /**
+   * @brief Set how the payload of the sent messages is transmitted. Received messages are handled automatically.
+   * @param [in] transport - the PayloadTransport to use.
+   * @param [in] num_slots - number of shared memory slots, used by PayloadTransport::shared_memory.
+   * @throws std::runtime_error if shared memory is not supported on this platform.
+   */
+  void setPayloadTransport(const PayloadTransport& transport, uint32_t num_slots = 4);
+
+  /**
+   * @brief Enables or disables the asynchronous send mode.
+   * @param [in] enabled - when enabled, sendMsg() serializes the message on the calling thread and queues it on a
+   * lock-free queue, a dedicated I/O thread owns the ZMQ socket and sends it. Disabling it sends the queued messages.
+   * @param [in] capacity - maximum number of queued messages, sendMsg() fails while the queue is full. An existing
+   * queue with another capacity is replaced, its other settings are kept.
+   * @param [in] custom_error - a string to prefix to the error messages printed by the I/O thread.
+   *
+   * It must not be called while other threads are sending, and the ZMQ socket options have to be set before enabling.
+   */
+  void setAsyncSend(bool enabled, size_t capacity = 1000, const std::string& custom_error = "[SIMPLE Error] - ");
+
+  /**
+   * @brief Bounds the messages waiting to be sent by a ZMQ_XPUB socket and sets what happens to the ones that do not
+   * fit. It enables the asynchronous send mode, the policy applies to its queue.
+   * @param [in] max_messages - maximum number of queued messages, also the ZMQ high water mark. The high water mark of
+   * a ZMQ_XPUB socket is one more, the welcome message takes a slot of each peer queue. 0 for no limit.
+   * @param [in] max_bytes - maximum size of the queued messages, in bytes. 0 for no limit.
+   * @param [in] policy - the BackpressurePolicy applied when a limit is reached.
+   * @param [in] custom_error - a string to prefix to the error messages printed by the I/O thread.
+   *
+   * The socket does not drop messages on its own anymore: a peer that does not keep up fills the queue instead.
+   * It replaces the queue of the asynchronous mode, it must not be called while other threads are sending.
+   */
+  void setBackpressure(size_t max_messages, size_t max_bytes, const BackpressurePolicy& policy,
+                       const std::string& custom_error = "[SIMPLE Error] - ");
+
+  /**
+   * @brief Coalesces the messages sent within a short window into a single batch frame, see sendBatch(). It enables
+   * the asynchronous send mode, the I/O thread coalesces the queued messages.
+   * @param [in] max_delay - maximum time a message waits for others once the I/O thread took it. 0 disables coalescing.
+   * @param [in] max_bytes - the coalesced messages are sent right away once their size reaches it.
+   * @param [in] custom_error - a string to prefix to the error messages printed by the I/O thread.
+   *
+   * Messages with a payload frame, a shared memory descriptor or a request envelope are sent on their own, in order.
+   * It must not be called while other threads are sending.
+   */
+  void setCoalescing(std::chrono::microseconds max_delay, size_t max_bytes,
+                     const std::string& custom_error = "[SIMPLE Error] - ");
+
+  /**
+   * @brief Returns the number of messages dropped by the asynchronous send mode because its queue was full.
+   */
+  uint64_t droppedMessages() const;
+
+  /**
+   * @brief Returns the number of received messages dropped because their shared memory payload had been overwritten
+   * already. It does not wait for the socket.
+   */
+  uint64_t lostPayloads() const;
+
+  /**
+   * @brief Returns whether a message is waiting to be received, without waiting for it.
+   */
+  bool hasPendingMsg();
+
+  /**
+   * @brief Returns the number of peers subscribed to the messages of a ZMQ_XPUB socket, -1 for any other socket.
+   *
+   * The subscriptions are counted as they arrive on the socket. In asynchronous mode the I/O thread counts them
+   * whenever it has nothing to send, a new subscriber is noticed within 10 milliseconds.
+   */
+  int subscriberCount() const;
+
+  /**
+   * @brief Returns whether a ZMQ_SUB socket has been welcomed by the ZMQ_XPUB socket it connected to, i.e. the
+   * Publisher accepted its connection.
+   *
+   * A ZMQ_XPUB socket welcomes its new peers as soon as it is used, e.g. to send a message or to count its subscribers.
+   * The welcome is received by receiveMsg(), which then returns false.
+   */
+  bool isWelcomed() const;
+
+  /**
+   * @brief Reports the connection events of the ZMQ socket to the given callback, through a SocketMonitor. It replaces
+   * the previous monitor, if any.
+   * @param [in] callback - called on the thread of the monitor. An empty callback only counts the events.
+   * @param [in] custom_error - a string to prefix to the error messages printed in failure cases.
+   * @throws std::runtime_error if ZMQ cannot monitor the socket.
+   *
+   * In asynchronous mode the socket belongs to the I/O thread, the monitor has to be set before enabling it.
+   */
+  void setMonitor(const SocketEventCallback& callback, const std::string& custom_error = "[SIMPLE Error] - ");
+
+  /**
+   * @brief Returns how many times the given event happened since the monitor was set, 0 without a monitor.
+   */
+  uint64_t eventCount(const SocketEvent& event) const;
+
+  /**
+   * @brief Returns whether messages of a received batch are still waiting to be returned by receiveMsg(). Polling the
+   * ZMQ socket does not report them.
+   */
+  bool hasBufferedMsg();
+
+  /**
+   * @brief Loans a shared memory slot of the given size, to fill a payload in place and send it without any copy.
+   * @return nullptr if PayloadTransport::shared_memory is not in use or no slot is free.
+   */
+  std::shared_ptr<void> loanSharedMemory(uint64_t size);
+
+  /**
+   * @brief Initialize the ZMQ socket given its type, in the ZMQ context of this GenericSocket.
    * @param [in] type - the ZMQ Socket Type.
    *
    * Accepted types are:
@@ -149,6 +382,9 @@ protected:
    * zmq_socket_type::sub - for a Subscriber.
    * zmq_socket_type::req - for a Client.
    * zmq_socket_type::rep - for a Server.
+   * zmq_socket_type::dealer - for an AsyncClient.
+   * zmq_socket_type::router - for a Server with deferred replies.
+   * zmq_socket_type::xpub - for a Publisher.
    */
   void initSocket(const zmq_socket_type& type);
 
@@ -162,6 +398,11 @@ protected:
    */
   bool isSocketValid();
 
+  /**
+   * @brief Returns the underlying ZMQ socket, e.g. to poll it with zmq_poll. nullptr if it has not been initialized.
+   */
+  void* nativeHandle();
+
   /**
    * @brief Query the endpoint that this object is bound to.
    *
@@ -171,10 +412,65 @@ protected:
   inline const std::string& endpoint() { return endpoint_; }
 
 private:
-  mutable std::mutex mutex_{};             //! Mutex for thread-safety.
-  std::string topic_{""};                  //! The message topic, internally defined for each SIMPLE message.
-  std::unique_ptr<zmq::socket_t> socket_;  //! The internal ZMQ socket.
-  std::string endpoint_{""};               //! Stores the used endpoint for connection.
+  /**
+   * @brief Receives and discards the remaining frames of a multi-part message. The mutex has to be locked.
+   */
+  void discardRemainingFrames();
+
+  /**
+   * @brief Serializes the given message into the frames to send. It does not need the mutex.
+   *
+   * If its payload cannot be written to shared memory, the error is printed after custom_error and the payload is
+   * sent inline.
+   */
+  void serialize(const simple_msgs::GenericMessage& msg, OutgoingMessage& outgoing,
+                 const std::string& custom_error) const;
+
+  /**
+   * @brief Serializes the given messages into the frames of a batch. It does not need the mutex.
+   */
+  void serializeBatch(const std::vector<const simple_msgs::GenericMessage*>& messages, OutgoingMessage& outgoing) const;
+
+  /**
+   * @brief Returns the next message of the received batch. The mutex has to be locked.
+   */
+  bool popBatchedMsg(simple_msgs::GenericMessage& msg);
+
+  /**
+   * @brief Replaces the queue of the asynchronous mode, if any, with one of the given settings. The queued messages are
+   * sent first, the coalescing settings are kept. The mutex has to be locked and the socket valid.
+   */
+  void replaceAsyncSender(size_t capacity, size_t max_bytes, const BackpressurePolicy& policy, bool report_drops,
+                          const std::string& custom_error);
+
+  /**
+   * @brief Returns whether a message is worth serializing, i.e. the socket is not a ZMQ_XPUB one or it seems to have
+   * subscribers. It reads the last count without the mutex, the subscriptions are only received if it is 0.
+   */
+  bool maySendToSubscribers() const;
+
+  /**
+   * @brief Sends the serialized frames, or queues them in asynchronous mode. A ZMQ_XPUB socket receives the pending
+   * subscriptions under the same lock, the frames are dropped if nobody is subscribed anymore.
+   */
+  bool send(OutgoingMessage& outgoing, const std::string& custom_error) const;
+
+  mutable std::mutex mutex_{};                                         //! Mutex for thread-safety.
+  std::string topic_{""};                                              //! The message topic of each SIMPLE message.
+  std::string context_{""};                                            //! The name of the ZMQ context of the socket.
+  std::unique_ptr<zmq::socket_t> socket_;                              //! The internal ZMQ socket.
+  std::string endpoint_{""};                                           //! Stores the used endpoint for connection.
+  std::unique_ptr<SharedMemoryPool> shared_memory_pool_{nullptr};      //! Slots for the sent payloads, if in use.
+  std::unique_ptr<SharedMemoryReader> shared_memory_reader_{nullptr};  //! Maps the received shared memory payloads.
+  std::unique_ptr<AsyncSender> async_sender_{nullptr};                 //! The I/O thread of the asynchronous mode.
+  std::shared_ptr<BuilderPool> builder_pool_{nullptr};                 //! Recycled builders for the sent messages.
+  PayloadTransport payload_transport_{PayloadTransport::flatbuffer};   //! How the sent payloads are transmitted.
+  std::unique_ptr<ReceivedBatch> received_batch_{nullptr};             //! The received batch, if any.
+  std::shared_ptr<std::atomic<int>> subscribers_{nullptr};             //! Subscribed peers of a ZMQ_XPUB socket.
+  std::atomic<bool> welcomed_{false};                                  //! Whether a ZMQ_XPUB socket welcomed this one.
+  std::atomic<uint64_t> lost_payloads_{0};                             //! Shared memory payloads received too late.
+  std::unique_ptr<SocketMonitor> monitor_{nullptr};                    //! Reports the connection events, if any.
+  mutable std::mutex monitor_mutex_{};                                 //! Guards monitor_, not the socket.
 };
 }  // Namespace simple.
 
@@ -0,0 +1,162 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_INTRA_PROCESS_HPP
+#define SIMPLE_INTRA_PROCESS_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "simple/backpressure.hpp"
+
+namespace simple {
+
+/**
+ * @class IntraProcessQueue intra_process.hpp.
+ * @brief A thread-safe queue of immutable messages delivered by an IntraProcessChannel to a single Subscriber.
+ *
+ * The queue is bounded, when it is full new messages are dropped, as it happens for a ZMQ socket reaching its high
+ * water mark, or the oldest ones with BackpressurePolicy::drop_oldest. The Publisher never waits for a queue.
+ */
+class IntraProcessQueue {
+public:
+  /**
+   * @brief Creates a queue that holds up to the given number of messages.
+   * @param [in] capacity - maximum number of messages waiting to be processed. Default 1000, as the ZMQ default HWM.
+   */
+  explicit IntraProcessQueue(size_t capacity = 1000);
+
+  /**
+   * @brief Adds a message to the queue.
+   * @return false if the queue is full and the message was dropped.
+   */
+  bool push(const std::shared_ptr<const void>& msg);
+
+  /**
+   * @brief Waits for a message to be available in the queue and removes it.
+   * @param [out] msg - the oldest message in the queue.
+   * @param [in] timeout - maximum time to wait for a message, in milliseconds.
+   * @return true if a message was available before the timeout expired.
+   */
+  bool pop(std::shared_ptr<const void>& msg, int timeout);
+
+  /**
+   * @brief Returns whether no message is waiting in the queue.
+   */
+  bool empty();
+
+  /**
+   * @brief Sets the capacity of the queue and what happens to the messages that do not fit.
+   * @param [in] capacity - maximum number of messages waiting to be processed, 0 for no limit.
+   * @param [in] policy - BackpressurePolicy::drop_oldest drops the oldest messages, any other policy the new ones.
+   */
+  void setLimits(size_t capacity, const BackpressurePolicy& policy);
+
+  /**
+   * @brief Returns the number of messages dropped because the queue was full.
+   */
+  uint64_t dropped();
+
+private:
+  std::mutex mutex_{};
+  std::condition_variable condition_{};
+  std::deque<std::shared_ptr<const void>> messages_{};
+  size_t capacity_{1000};
+  BackpressurePolicy policy_{BackpressurePolicy::drop_newest};
+  uint64_t dropped_{0};
+};
+
+/**
+ * @class IntraProcessChannel intra_process.hpp.
+ * @brief An IntraProcessChannel connects a Publisher and any number of Subscribers living in the same process.
+ *
+ * Messages published on a channel are neither serialized nor sent through a ZMQ socket, they are shared as immutable
+ * std::shared_ptr<const T> with every attached Subscriber. Delivering a message costs a reference count increment per
+ * Subscriber, regardless of its size.
+ * Channels are identified by addresses in the form inproc+direct://\<NAME\>, e.g. inproc+direct://camera.
+ */
+class IntraProcessChannel {
+public:
+  /**
+   * @brief Returns true if the given address refers to an IntraProcessChannel.
+   */
+  static bool isIntraProcess(const std::string& address);
+
+  /**
+   * @brief Returns the channel with the given address and binds a Publisher to it. The channel is created if needed.
+   * @param [in] address - in the form inproc+direct://\<NAME\>.
+   * @param [in] type - the type of the messages exchanged on the channel.
+   * @throws std::runtime_error if the address is invalid, if another Publisher is already bound to it or if the
+   * channel exchanges a different type of message.
+   */
+  static std::shared_ptr<IntraProcessChannel> bind(const std::string& address, const std::type_index& type);
+
+  /**
+   * @brief Returns the channel with the given address, it is created if no Publisher is bound to it yet.
+   * @param [in] address - in the form inproc+direct://\<NAME\>.
+   * @param [in] type - the type of the messages exchanged on the channel.
+   * @throws std::runtime_error if the address is invalid or if the channel exchanges a different type of message.
+   */
+  static std::shared_ptr<IntraProcessChannel> connect(const std::string& address, const std::type_index& type);
+
+  IntraProcessChannel(const std::string& address, const std::type_index& type);
+
+  /**
+   * @brief Releases the channel from its Publisher, another one can be bound to it afterwards.
+   */
+  void unbind();
+
+  /**
+   * @brief Attaches a Subscriber queue to the channel, it will receive all the messages published from now on.
+   */
+  void attach(const std::shared_ptr<IntraProcessQueue>& queue);
+
+  /**
+   * @brief Detaches a Subscriber queue from the channel.
+   */
+  void detach(const std::shared_ptr<IntraProcessQueue>& queue);
+
+  /**
+   * @brief Delivers the given message to all the attached queues.
+   */
+  void deliver(const std::shared_ptr<const void>& msg) const;
+
+  /**
+   * @brief Returns the number of attached Subscriber queues.
+   */
+  size_t subscriberCount() const;
+
+  /**
+   * @brief Returns whether a Publisher is bound to the channel.
+   */
+  bool isBound() const;
+
+  /**
+   * @brief Returns the address of the channel.
+   */
+  inline const std::string& address() const { return address_; }
+
+private:
+  mutable std::mutex mutex_{};                               //! Mutex for thread-safety.
+  std::string address_{""};                                  //! The address identifying the channel.
+  std::type_index type_;                                     //! The type of messages exchanged on the channel.
+  bool bound_{false};                                        //! Whether a Publisher is bound to the channel.
+  std::vector<std::shared_ptr<IntraProcessQueue>> queues_{};  //! The queues of the attached Subscribers.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_INTRA_PROCESS_HPP
@@ -0,0 +1,82 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_MESSAGE_BATCH_HPP
+#define SIMPLE_MESSAGE_BATCH_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace simple {
+
+/**
+ * @class MessageBatch message_batch.hpp.
+ * @brief A batch of received messages, passed to the batch callback of a Subscriber.
+ * @tparam T The simple_msgs type of the messages.
+ *
+ * The messages live in a vector owned by the Subscriber which only grows: a batch is made of its first size()
+ * elements, the following ones are left from larger batches. Each message is received into an element that already
+ * exists, which reuses whatever memory a previous message left in it, so no message is constructed once the vector
+ * has grown to the usual batch size.
+ */
+template <typename T>
+class MessageBatch {
+public:
+  using const_iterator = typename std::vector<T>::const_iterator;
+
+  MessageBatch() = default;
+
+  // A MessageBatch cannot be copied nor moved, the batch callback only borrows it.
+  MessageBatch(const MessageBatch&) = delete;
+  MessageBatch& operator=(const MessageBatch&) = delete;
+
+  /**
+   * @brief Returns the number of messages in the batch.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Returns whether the batch holds no message.
+   */
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief Returns the message at the given position, it has to be smaller than size().
+   */
+  const T& operator[](size_t index) const { return messages_[index]; }
+
+  const_iterator begin() const { return messages_.begin(); }
+  const_iterator end() const { return messages_.begin() + static_cast<std::ptrdiff_t>(size_); }
+
+  /**
+   * @brief Empties the batch, the messages are kept to be reused.
+   */
+  void clear() { size_ = 0; }
+
+  /**
+   * @brief Returns the element receiving the next message of the batch, it is only part of the batch after push().
+   */
+  T& next() {
+    if (size_ == messages_.size()) { messages_.emplace_back(); }
+    return messages_[size_];
+  }
+
+  /**
+   * @brief Adds the element returned by next() to the batch.
+   */
+  void push() { ++size_; }
+
+private:
+  std::vector<T> messages_{};  //! The messages of this batch and the ones left from larger batches.
+  size_t size_{0};             //! Number of messages in this batch.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_MESSAGE_BATCH_HPP
@@ -0,0 +1,87 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_MPSC_QUEUE_HPP
+#define SIMPLE_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+namespace simple {
+
+/**
+ * @class MpscQueue mpsc_queue.hpp.
+ * @brief An unbounded lock-free queue with many producers and a single consumer.
+ * @tparam T The type of the queued elements, it has to be default constructible and movable.
+ *
+ * push() is wait-free: a producer never waits for other producers nor for the consumer. It is an intrusive linked
+ * list in the style of Dmitry Vyukov's MPSC queue. An element that is being pushed becomes visible to the consumer
+ * only once its producer linked it, until then pop() may report the queue as empty.
+ */
+template <typename T>
+class MpscQueue {
+public:
+  MpscQueue() = default;
+
+  ~MpscQueue() {
+    // The last consumed node is still referenced by tail_, unless it is the stub.
+    auto node = tail_->next.load(std::memory_order_acquire);
+    if (tail_ != &stub_) { delete tail_; }
+    while (node != nullptr) {
+      auto next = node->next.load(std::memory_order_acquire);
+      delete node;
+      node = next;
+    }
+  }
+
+  // An MpscQueue cannot be copied nor moved, producers may hold a reference to it.
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /**
+   * @brief Adds an element to the queue. It can be called concurrently by any number of threads.
+   */
+  void push(T value) {
+    auto node = new Node{std::move(value)};
+    auto previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  /**
+   * @brief Removes the oldest element from the queue. It must be called by a single thread at a time.
+   * @return false if the queue is empty.
+   */
+  bool pop(T& value) {
+    auto tail = tail_;
+    auto next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) { return false; }
+    value = std::move(next->value);
+    next->value = T{};
+    tail_ = next;
+    if (tail != &stub_) { delete tail; }
+    return true;
+  }
+
+private:
+  struct Node {
+    T value{};
+    std::atomic<Node*> next{nullptr};
+
+    Node() = default;
+    explicit Node(T&& v) : value(std::move(v)) {}
+  };
+
+  Node stub_{};                      //! Placeholder node, the queue is empty when the tail has no successor.
+  std::atomic<Node*> head_{&stub_};  //! The most recently pushed node, shared by all the producers.
+  Node* tail_{&stub_};               //! The last consumed node, owned by the consumer.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_MPSC_QUEUE_HPP
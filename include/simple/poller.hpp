@@ -0,0 +1,51 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_POLLER_HPP
+#define SIMPLE_POLLER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "simple/intra_process.hpp"
+
+namespace simple {
+
+/**
+ * @brief What poll() waits on for a single Subscriber: its ZMQ socket, or the queue of its intra-process channel.
+ */
+struct PollItem {
+  void* socket{nullptr};                              //! The ZMQ socket, if any.
+  std::shared_ptr<IntraProcessQueue> queue{nullptr};  //! The intra-process queue, if any.
+  bool buffered{false};                               //! Whether messages of a received batch are still waiting.
+  bool ready{false};                                  //! Whether a message is waiting, set by poll().
+};
+
+/**
+ * @brief Waits until a message is waiting on any of the given items, on the calling thread.
+ * @param [in,out] items - the items to wait on, poll() sets whether each of them is ready.
+ * @param [in] timeout - maximum time to wait. A negative timeout waits indefinitely, 0 does not wait at all.
+ * @return the number of ready items, 0 if the timeout expired.
+ *
+ * ZMQ sockets are polled with millisecond resolution. Intra-process queues cannot be polled by ZMQ, while any of the
+ * items is an intra-process queue the sockets are polled in slices of one millisecond.
+ */
+size_t poll(std::vector<PollItem>& items, std::chrono::microseconds timeout);
+
+/**
+ * @brief Waits until a message is waiting on the given item, like poll() on a single item without allocating.
+ * @return 1 if the item is ready, 0 if the timeout expired.
+ */
+size_t poll(PollItem& item, std::chrono::microseconds timeout);
+}  // Namespace simple.
+
+#endif  // SIMPLE_POLLER_HPP
@@ -11,20 +11,28 @@
 #ifndef SIMPLE_PUBLISHER_HPP
 #define SIMPLE_PUBLISHER_HPP
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
 
 #include "simple/generic_socket.hpp"
+#include "simple/intra_process.hpp"
 
 namespace simple {
 /**
  * @class Publisher publisher.hpp.
- * @brief The Publisher class creates a ZMQ Socket of type ZMQ_PUB that can publish messages of type T passed to its
+ * @brief The Publisher class creates a ZMQ Socket of type ZMQ_XPUB that can publish messages of type T passed to its
  * publish() method.
  * @tparam T The simple_msgs type to publish.
  *
  * Implements the logic for a Publisher in the Publisher / Subscriber paradigm. A Publisher can publish messages of
  * types T that can be received by any number of Subscribers.
+ * A Publisher bound to an address in the form inproc+direct://\<NAME\> does not use a ZMQ socket, it shares its
+ * messages with the Subscribers in the same process through an IntraProcessChannel, without serializing them.
  */
 template <typename T>
 class Publisher {
@@ -32,13 +40,20 @@ public:
   Publisher() = default;
 
   /**
-   * @brief Creates a ZMQ_PUB socket and binds it to the given address.
+   * @brief Creates a ZMQ_XPUB socket and binds it to the given address.
    *
    * Subscribers can subscribe to a Publisher connecting to its address.
-   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555.
+   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555, or
+   * inproc+direct://\<NAME\> for Subscribers living in the same process.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
    */
-  explicit Publisher<T>(const std::string& address) : socket_{zmq_socket_type::pub, T::getTopic()} {
-    socket_.bind(address);
+  explicit Publisher<T>(const std::string& address, const std::string& context = "") {
+    if (IntraProcessChannel::isIntraProcess(address)) {
+      channel_ = IntraProcessChannel::bind(address, std::type_index(typeid(T)));
+    } else {
+      socket_ = GenericSocket{zmq_socket_type::xpub, T::getTopic(), context};
+      socket_.bind(address);
+    }
   }
 
   // A Publisher cannot be copied, only moved.
@@ -53,16 +68,206 @@ public:
   /**
    * @brief Move assignment operator.
    */
-  Publisher& operator=(Publisher&& other) = default;
+  Publisher& operator=(Publisher&& other) {
+    if (this != std::addressof(other)) {
+      if (channel_ != nullptr) { channel_->unbind(); }
+      socket_ = std::move(other.socket_);
+      channel_ = std::move(other.channel_);
+      custom_error_ = std::move(other.custom_error_);
+    }
+    return *this;
+  }
 
-  ~Publisher() = default;
+  ~Publisher() {
+    if (channel_ != nullptr) { channel_->unbind(); }  //! Another Publisher can now bind to the channel.
+  }
 
   /**
    * @brief Publishes the given message of type T through the open socket.
    * @param [in] msg - simple_msgs class wrapper for Flatbuffer messages.
    * @return success or failure of the publishing.
+   *
+   * On an intra-process channel a copy of the message is shared with the Subscribers. In asynchronous mode, success
+   * means that the message has been queued for sending. Without Subscribers the message is not even serialized, nobody
+   * would receive it.
+   */
+  bool publish(const T& msg) {
+    if (channel_ != nullptr) { return !hasSubscribers() || publish(std::make_shared<const T>(msg)); }
+    return socket_.sendMsg(msg, custom_error_);
+  }
+
+  /**
+   * @brief Publishes the given message of type T through the open socket.
+   * @param [in] msg - shared pointer to a simple_msgs class wrapper for Flatbuffer messages.
+   * @return success or failure of the publishing.
+   *
+   * On an intra-process channel the message itself is shared with the Subscribers, it must not be modified afterwards.
+   * An Image holding a raw pointer to its data requires that data to outlive the processing of every Subscriber.
+   */
+  bool publish(const std::shared_ptr<const T>& msg) {
+    if (msg == nullptr) { return false; }
+    if (channel_ != nullptr) {
+      channel_->deliver(msg);
+      return true;
+    }
+    return socket_.sendMsg(*msg, custom_error_);
+  }
+
+  /**
+   * @brief Publishes the given messages of type T as a single batch: one topic frame and a single frame holding all of
+   * them, instead of two frames per message.
+   * @param [in] msgs - the messages to publish, in order.
+   * @return success or failure of the publishing.
+   *
+   * Subscribers receive the messages one by one, as if they were published separately. The payloads, e.g. the data of
+   * an Image, are serialized within the messages. With a BackpressurePolicy, a batch counts as a single message. On an
+   * intra-process channel, a copy of each message is shared with the Subscribers.
+   */
+  bool publishBatch(const std::vector<T>& msgs) { return publishBatch(msgs.begin(), msgs.end()); }
+
+  /**
+   * @brief Publishes the messages of type T in the range [first, last) as a single batch, see publishBatch().
+   * @param [in] first - iterator to the first message.
+   * @param [in] last - iterator past the last message.
+   * @return success or failure of the publishing.
+   */
+  template <typename Iterator>
+  bool publishBatch(Iterator first, Iterator last) {
+    if (channel_ != nullptr) {
+      for (; first != last && hasSubscribers(); ++first) { channel_->deliver(std::make_shared<const T>(*first)); }
+      return true;
+    }
+    std::vector<const simple_msgs::GenericMessage*> batch{};
+    for (; first != last; ++first) { batch.push_back(&*first); }
+    return socket_.sendBatch(batch, custom_error_);
+  }
+
+  /**
+   * @brief Sets how the payload of the published messages, e.g. the data of an Image, is transmitted.
+   * @param [in] transport - with PayloadTransport::shared_memory the payload is written to a shared memory slot and
+   * only its descriptor is sent. Subscribers on other hosts cannot receive such messages. With
+   * PayloadTransport::zmq_frame the payload is sent as a separate frame, data owned by the message through a
+   * std::shared_ptr is not copied and it is kept alive until it has been transmitted.
+   * @param [in] num_slots - number of shared memory slots. A slot is reused only once every Subscriber released it, a
+   * message is sent with its payload inline while no slot is free. A Subscriber lagging behind by more messages than
+   * slots finds the payload overwritten and drops the message, see Subscriber::droppedMessages().
+   * @throws std::runtime_error if shared memory is not supported on this platform.
+   */
+  void setPayloadTransport(const PayloadTransport& transport, uint32_t num_slots = 4) {
+    if (channel_ == nullptr) { socket_.setPayloadTransport(transport, num_slots); }
+  }
+
+  /**
+   * @brief Enables or disables the asynchronous publishing mode.
+   * @param [in] enabled - when enabled, publish() serializes the message on the calling thread and hands it over to a
+   * dedicated I/O thread through a lock-free queue. Threads sharing this Publisher do not wait on each other.
+   * @param [in] capacity - maximum number of messages waiting to be sent, publish() returns false when it is reached.
+   *
+   * It must not be called while other threads are publishing. Disabling it sends the messages still queued.
+   */
+  void setAsyncPublishing(bool enabled, size_t capacity = 1000) {
+    if (channel_ == nullptr) { socket_.setAsyncSend(enabled, capacity, custom_error_); }
+  }
+
+  /**
+   * @brief Bounds the messages waiting to be sent and sets what happens when a Subscriber does not keep up.
+   * @param [in] max_messages - maximum number of messages waiting to be sent, and queued by ZMQ for each Subscriber.
+   * 0 for no limit.
+   * @param [in] max_bytes - maximum size of the messages waiting to be sent, in bytes. 0 for no limit.
+   * @param [in] policy - BackpressurePolicy::block makes publish() wait for room, BackpressurePolicy::drop_newest makes
+   * it drop the new message and return false, BackpressurePolicy::drop_oldest drops the oldest queued messages instead.
+   *
+   * It enables the asynchronous publishing mode, the policy applies to its queue. Once the ZMQ queue of a Subscriber
+   * is full, the Publisher waits for it: the slowest Subscriber sets the pace. Every dropped message is counted, see
+   * droppedMessages(). On an intra-process channel the queue of each Subscriber applies its own policy instead.
+   *
+   * The ZMQ queue of each Subscriber has one more slot than max_messages, taken by the welcome message of a new
+   * Subscriber until it is sent, see waitForSubscribers(). Once it is sent, that queue holds up to max_messages + 1
+   * messages.
+   *
+   * It replaces the queue of the asynchronous mode, it must not be called while other threads are publishing.
+   */
+  void setBackpressure(size_t max_messages, size_t max_bytes,
+                       const BackpressurePolicy& policy = BackpressurePolicy::drop_newest) {
+    if (channel_ == nullptr) { socket_.setBackpressure(max_messages, max_bytes, policy, custom_error_); }
+  }
+
+  /**
+   * @brief Enables or disables the coalescing of small messages, a throughput mode for frequent publishers.
+   * @param [in] max_delay - the messages published within this window are sent together as a single batch, as with
+   * publishBatch(), none of them waits longer than that. 0 disables coalescing.
+   * @param [in] max_bytes - a batch is sent right away once its messages reach this size. Default 64 KiB.
+   *
+   * It enables the asynchronous publishing mode, publish() only queues the message. Subscribers receive the messages
+   * one by one, as if they were sent separately. Messages whose payload is sent as a separate frame or in shared
+   * memory are not coalesced. It must not be called while other threads are publishing.
+   */
+  void setCoalescing(std::chrono::microseconds max_delay, size_t max_bytes = 65536) {
+    if (channel_ == nullptr) { socket_.setCoalescing(max_delay, max_bytes, custom_error_); }
+  }
+
+  /**
+   * @brief Returns the number of messages dropped because the queue of the asynchronous publishing mode was full.
+   */
+  uint64_t droppedMessages() const { return socket_.droppedMessages(); }
+
+  /**
+   * @brief Returns the number of Subscribers currently subscribed to this Publisher.
+   *
+   * Over ZMQ, a Subscriber is counted once its subscription reached the Publisher, shortly after it connected. The
+   * messages published before that are not received by it.
+   */
+  int subscriberCount() const {
+    if (channel_ != nullptr) { return static_cast<int>(channel_->subscriberCount()); }
+    return socket_.subscriberCount();
+  }
+
+  /**
+   * @brief Returns whether any Subscriber is currently subscribed to this Publisher, see subscriberCount().
+   */
+  bool hasSubscribers() const { return subscriberCount() > 0; }
+
+  /**
+   * @brief Waits until the given number of Subscribers subscribed to this Publisher, instead of sleeping for a fixed
+   * time before publishing the first messages.
+   * @param [in] count - the number of Subscribers to wait for.
+   * @param [in] timeout - the maximum time to wait.
+   * @return true if enough Subscribers subscribed in time, the messages published from now on reach all of them.
+   */
+  bool waitForSubscribers(size_t count = 1,
+                          std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (subscriberCount() < static_cast<int>(count)) {
+      if (std::chrono::steady_clock::now() >= deadline) { return false; }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  /**
+   * @brief Reports the connection events of the Publisher, e.g. a Subscriber connecting to it, to the given callback.
+   * @param [in] callback - called on a dedicated thread with every SocketEvent and the endpoint it refers to.
+   * @throws std::runtime_error if ZMQ cannot monitor the socket.
+   *
+   * It has to be set before enabling the asynchronous publishing mode. It has no effect on an intra-process channel.
+   */
+  void setMonitor(const SocketEventCallback& callback) {
+    if (channel_ == nullptr) { socket_.setMonitor(callback, custom_error_); }
+  }
+
+  /**
+   * @brief Returns how many times the given SocketEvent happened since setMonitor() was called.
+   */
+  uint64_t eventCount(const SocketEvent& event) const { return socket_.eventCount(event); }
+
+  /**
+   * @brief Loans a shared memory slot of the given size in bytes, e.g. to fill the data of an Image in place.
+   *
+   * Publishing a message whose payload is the loaned memory sends it without copying it. The memory must not be
+   * modified after it has been published.
+   * @return nullptr if PayloadTransport::shared_memory is not in use or no slot is free.
    */
-  bool publish(const T& msg) { return socket_.sendMsg(msg, "[Simple Publisher] - "); }
+  std::shared_ptr<void> loanSharedMemory(uint64_t size) { return socket_.loanSharedMemory(size); }
 
   /**
    * @brief Query the endpoint that this object is bound to.
@@ -70,10 +275,12 @@ public:
    * Can be used to find the bound port if binding to ephemeral ports.
    * @return the endpoint in form of a ZMQ DSN string, i.e. "tcp://0.0.0.0:8000"
    */
-  const std::string& endpoint() { return socket_.endpoint(); }
+  const std::string& endpoint() { return channel_ != nullptr ? channel_->address() : socket_.endpoint(); }
 
 private:
-  GenericSocket socket_{};  //! The internal socket.
+  GenericSocket socket_{};                                 //! The internal socket.
+  std::shared_ptr<IntraProcessChannel> channel_{nullptr};  //! The channel used for intra-process publishing.
+  std::string custom_error_{"[Simple Publisher] - "};      //! Prefix of the error messages, built only once.
 };
 }  // Namespace simple.
 
@@ -0,0 +1,146 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_REPLY_ROUTER_HPP
+#define SIMPLE_REPLY_ROUTER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simple/generic_socket.hpp"
+
+namespace zmq {
+class socket_t;
+}  // namespace zmq
+
+namespace simple {
+
+/**
+ * @class ReplyRouter reply_router.hpp.
+ * @brief Receives the requests of a Server on a ZMQ_ROUTER socket and sends back their replies whenever they are
+ * ready, from any thread and in any order.
+ *
+ * A dedicated I/O thread owns the socket. It hands every request over to a handler together with an id, and keeps the
+ * routing envelope of the request under that id. A reply is queued with the id of its request, the I/O thread wakes
+ * up and sends it to the Client that is waiting for it. Requests are therefore received while the previous ones are
+ * still being computed, a long request does not block the others.
+ */
+class ReplyRouter : public std::enable_shared_from_this<ReplyRouter> {
+public:
+  /**
+   * @brief A reply waiting to be sent, it holds the message to send.
+   */
+  class Reply {
+  public:
+    virtual ~Reply() = default;
+
+    /**
+     * @brief The message to send.
+     */
+    virtual const simple_msgs::GenericMessage& message() const = 0;
+  };
+
+  /**
+   * @brief Called on the I/O thread whenever a request is waiting, it has to receive it with receive().
+   */
+  using RequestHandler = std::function<void(ReplyRouter& router)>;
+
+  /**
+   * @brief Creates a ZMQ_ROUTER socket and binds it to the given address.
+   * @param [in] address - address the server binds to, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>.
+   * @param [in] topic - the message topic.
+   * @param [in] linger - Time, in msec, unsent replies linger in memory after socket is closed.
+   * @param [in] context - the name of the ZMQ context of the socket, the default context if empty.
+   * @throws std::runtime_error.
+   */
+  ReplyRouter(const std::string& address, const std::string& topic, int linger, const std::string& context = "");
+
+  /**
+   * @brief Stops the I/O thread, the replies that have not been sent yet are dropped.
+   */
+  ~ReplyRouter();
+
+  // A ReplyRouter cannot be copied nor moved, its thread refers to it.
+  ReplyRouter(const ReplyRouter&) = delete;
+  ReplyRouter& operator=(const ReplyRouter&) = delete;
+
+  /**
+   * @brief Starts the I/O thread. The ReplyRouter has to be owned by a std::shared_ptr, the handler may keep it.
+   */
+  void start(const RequestHandler& handler);
+
+  /**
+   * @brief Stops the I/O thread. It must not be called by the handler.
+   */
+  void stop();
+
+  /**
+   * @brief Receives a request. Runs on the I/O thread, within the handler.
+   * @param [in,out] msg - the message to populate with the request.
+   * @param [out] request_id - the id to reply to this request with.
+   * @return false if no valid request was received.
+   */
+  bool receive(simple_msgs::GenericMessage& msg, uint64_t& request_id);
+
+  /**
+   * @brief Queues the reply to the given request, the I/O thread sends it. It can be called by any thread.
+   * @return false if the request has already been replied or cancelled, or the I/O thread has stopped.
+   */
+  bool reply(uint64_t request_id, std::unique_ptr<Reply> reply);
+
+  /**
+   * @brief Forgets the given request, that will not be replied. Its Client waits until it times out.
+   */
+  void cancel(uint64_t request_id);
+
+  /**
+   * @brief Returns the endpoint the ZMQ_ROUTER socket is bound to, i.e. "tcp://0.0.0.0:8000".
+   */
+  inline const std::string& endpoint() { return socket_.endpoint(); }
+
+private:
+  struct QueuedReply {
+    std::vector<std::string> envelope;  //! The routing envelope of the request.
+    std::unique_ptr<Reply> reply;       //! The reply to send.
+  };
+
+  /**
+   * @brief Wakes the I/O thread up from zmq_poll. The mutex has to be locked.
+   */
+  void wake();
+
+  void run();
+
+  /**
+   * @brief Sends the queued replies. Runs on the I/O thread.
+   */
+  void sendReplies();
+
+  GenericSocket socket_{};                                  //! The ZMQ_ROUTER socket, used by the I/O thread only.
+  RequestHandler handler_{};                                //! Receives the requests.
+  std::mutex mutex_{};                                      //! Mutex for the pending requests and the replies.
+  bool alive_{false};                                       //! Whether the I/O thread has to keep running.
+  std::map<uint64_t, std::vector<std::string>> pending_{};  //! Routing envelopes of the requests to reply, by id.
+  std::deque<QueuedReply> replies_{};                       //! Replies waiting to be sent.
+  uint64_t next_id_{0};                                     //! Id of the next request.
+  std::unique_ptr<zmq::socket_t> wake_receiver_;            //! Polled to wake the I/O thread up.
+  std::unique_ptr<zmq::socket_t> wake_sender_;              //! Wakes the I/O thread up.
+  std::thread thread_{};                                    //! The I/O thread.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_REPLY_ROUTER_HPP
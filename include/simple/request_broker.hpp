@@ -0,0 +1,80 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_REQUEST_BROKER_HPP
+#define SIMPLE_REQUEST_BROKER_HPP
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace zmq {
+class socket_t;
+}  // namespace zmq
+
+namespace simple {
+
+/**
+ * @class RequestBroker request_broker.hpp.
+ * @brief Distributes the requests received on an address among the worker sockets of a multi-worker Server.
+ *
+ * A ZMQ_ROUTER socket bound to the Server address receives the requests of all the Clients, a ZMQ_DEALER socket bound
+ * to an inproc address hands them over to the ZMQ_REP sockets of the workers connected to it, and the replies travel
+ * back the same way. The two sockets are connected by zmq_proxy on a dedicated thread.
+ * The DEALER sends every request to the next worker able to accept it. Since its queues are kept short, a worker busy
+ * with a long request holds at most a couple of further requests, the others go to the idle workers.
+ */
+class RequestBroker {
+public:
+  /**
+   * @brief Binds the ROUTER socket to the given address and starts the proxy thread.
+   * @param [in] address - address the server binds to, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>.
+   * @param [in] linger - Time the unsent replies linger in memory after the socket is closed. In milliseconds.
+   * @param [in] context - the name of the ZMQ context of the sockets, the workers have to use the same one.
+   * @throws std::runtime_error.
+   */
+  RequestBroker(const std::string& address, int linger, const std::string& context = "");
+
+  /**
+   * @brief Stops the proxy thread and closes the sockets.
+   */
+  ~RequestBroker();
+
+  // A RequestBroker cannot be copied nor moved, its thread refers to it.
+  RequestBroker(const RequestBroker&) = delete;
+  RequestBroker& operator=(const RequestBroker&) = delete;
+
+  /**
+   * @brief Returns the inproc address the worker sockets connect to.
+   */
+  inline const std::string& workerAddress() const { return worker_address_; }
+
+  /**
+   * @brief Returns the endpoint the ROUTER socket is bound to, i.e. "tcp://0.0.0.0:8000".
+   */
+  inline const std::string& endpoint() const { return endpoint_; }
+
+  /**
+   * @brief High water mark of the worker sockets, it keeps the queue of a busy worker short.
+   */
+  static constexpr int worker_high_water_mark{1};
+
+private:
+  std::unique_ptr<zmq::socket_t> frontend_{nullptr};  //! The ROUTER socket receiving the requests.
+  std::unique_ptr<zmq::socket_t> backend_{nullptr};   //! The DEALER socket forwarding the requests to the workers.
+  std::unique_ptr<zmq::socket_t> control_{nullptr};   //! Controls the proxy from the proxy thread.
+  std::unique_ptr<zmq::socket_t> stopper_{nullptr};   //! Sends the TERMINATE command to the proxy.
+  std::string worker_address_{""};                    //! The address of the DEALER socket.
+  std::string endpoint_{""};                          //! The endpoint of the ROUTER socket.
+  std::thread thread_{};                              //! The proxy thread.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_REQUEST_BROKER_HPP
@@ -0,0 +1,140 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_REQUEST_PIPELINE_HPP
+#define SIMPLE_REQUEST_PIPELINE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "simple/generic_socket.hpp"
+
+namespace zmq {
+class socket_t;
+}  // namespace zmq
+
+namespace simple {
+
+/**
+ * @class RequestPipeline request_pipeline.hpp.
+ * @brief Sends requests through a ZMQ_DEALER socket without waiting for the previous replies, and matches every
+ * reply to its request through a request id.
+ *
+ * Every request is sent with an envelope holding its id, which a ZMQ_REP socket sends back with the reply. Any number
+ * of requests can be in flight on the same connection, and their replies can arrive in any order. A dedicated I/O
+ * thread owns the socket, it sends the submitted requests, receives the replies and expires the requests that are not
+ * answered in time.
+ */
+class RequestPipeline {
+public:
+  /**
+   * @brief A request in flight, it holds the message to send and receives its reply.
+   */
+  class Request {
+  public:
+    virtual ~Request() = default;
+
+    /**
+     * @brief The message to send.
+     */
+    virtual const simple_msgs::GenericMessage& message() const = 0;
+
+    /**
+     * @brief The message that receives the reply.
+     */
+    virtual simple_msgs::GenericMessage& reply() = 0;
+
+    /**
+     * @brief Called on the I/O thread once the reply has been received, or if the request failed or timed out.
+     */
+    virtual void complete(bool success) = 0;
+  };
+
+  /**
+   * @brief Creates a ZMQ_DEALER socket, connects it to the given address and starts the I/O thread.
+   * @param [in] address - address of the server, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>.
+   * @param [in] topic - the message topic.
+   * @param [in] timeout - Time, in msec, a request waits for its reply.
+   * @param [in] linger - Time, in msec, unsent messages linger in memory after socket is closed.
+   * @param [in] context - the name of the ZMQ context of the socket, the default context if empty.
+   * @throws std::runtime_error.
+   */
+  RequestPipeline(const std::string& address, const std::string& topic, int timeout, int linger,
+                  const std::string& context = "");
+
+  /**
+   * @brief Stops the I/O thread, the requests still in flight fail.
+   */
+  ~RequestPipeline();
+
+  // A RequestPipeline cannot be copied nor moved, its thread refers to it.
+  RequestPipeline(const RequestPipeline&) = delete;
+  RequestPipeline& operator=(const RequestPipeline&) = delete;
+
+  /**
+   * @brief Queues a request to be sent by the I/O thread. It can be called by any thread.
+   */
+  void submit(std::unique_ptr<Request> request);
+
+  /**
+   * @brief Returns the endpoint of the socket.
+   */
+  inline const std::string& endpoint() { return socket_.endpoint(); }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct InFlight {
+    std::unique_ptr<Request> request;  //! The request waiting for its reply.
+    Clock::time_point deadline;        //! When the request times out.
+  };
+
+  /**
+   * @brief Wakes the I/O thread up from zmq_poll. The mutex has to be locked.
+   */
+  void wake();
+
+  void run();
+
+  /**
+   * @brief Sends the submitted requests. Runs on the I/O thread.
+   */
+  void sendSubmitted();
+
+  /**
+   * @brief Receives a reply and completes its request. Runs on the I/O thread.
+   */
+  void receiveReply();
+
+  /**
+   * @brief Fails the requests whose deadline has passed. Runs on the I/O thread.
+   */
+  void expire();
+
+  GenericSocket socket_{};                            //! The ZMQ_DEALER socket, used by the I/O thread only.
+  std::chrono::milliseconds timeout_{2000};           //! Time a request waits for its reply.
+  std::mutex mutex_{};                                //! Mutex for the submitted requests.
+  std::deque<std::unique_ptr<Request>> submitted_{};  //! Requests waiting to be sent.
+  bool alive_{true};                                  //! Whether the I/O thread has to keep running.
+  std::map<uint64_t, InFlight> in_flight_{};          //! Requests sent, by id. Ids grow with the deadlines.
+  uint64_t next_id_{0};                               //! Id of the next request.
+  std::unique_ptr<zmq::socket_t> wake_receiver_;      //! Polled to wake the I/O thread up.
+  std::unique_ptr<zmq::socket_t> wake_sender_;        //! Wakes the I/O thread up.
+  std::thread thread_{};                              //! The I/O thread.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_REQUEST_PIPELINE_HPP
@@ -15,11 +15,76 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
+#include "simple/executor.hpp"
 #include "simple/generic_socket.hpp"
+#include "simple/reply_router.hpp"
+#include "simple/request_broker.hpp"
 
 namespace simple {
+template <typename T>
+class Server;
+
+/**
+ * @class DeferredReply server.hpp.
+ * @brief The DeferredReply class sends the reply to a request received by a Server with deferred replies. It can be
+ * copied, moved to another thread and used at any time, only the first reply is sent.
+ * @tparam T The simple_msgs type to use.
+ *
+ * A request whose replies have all been destroyed without sending is dropped, its Client waits until it times out.
+ */
+template <typename T>
+class DeferredReply {
+public:
+  DeferredReply() = default;
+
+  /**
+   * @brief Sends the given reply to the Client waiting for it. It can be called by any thread.
+   * @param [in] msg - the reply.
+   * @return false if the request has already been replied or the Server has been stopped.
+   */
+  bool send(const T& msg) const {
+    if (state_ == nullptr || state_->replied.exchange(true)) { return false; }
+    auto router = state_->router.lock();
+    return router != nullptr && router->reply(state_->request_id, std::unique_ptr<ReplyRouter::Reply>(new Reply{msg}));
+  }
+
+  /**
+   * @brief Returns whether the request is still waiting for its reply.
+   */
+  bool isPending() const { return state_ != nullptr && !state_->replied.load(); }
+
+private:
+  friend class Server<T>;
+
+  struct Reply : public ReplyRouter::Reply {
+    explicit Reply(const T& reply) : msg{reply} {}
+    const simple_msgs::GenericMessage& message() const override { return msg; }
+
+    T msg;  //! The reply to send.
+  };
+
+  struct State {
+    State(const std::shared_ptr<ReplyRouter>& reply_router, uint64_t id) : router{reply_router}, request_id{id} {}
+    ~State() {
+      if (replied.load()) { return; }
+      auto reply_router = router.lock();
+      if (reply_router != nullptr) { reply_router->cancel(request_id); }
+    }
+
+    std::weak_ptr<ReplyRouter> router;  //! The router that received the request.
+    uint64_t request_id{0};             //! The id of the request within its router.
+    std::atomic<bool> replied{false};   //! Whether the reply has been sent.
+  };
+
+  DeferredReply(const std::shared_ptr<ReplyRouter>& router, uint64_t request_id)
+    : state_{std::make_shared<State>(router, request_id)} {}
+
+  std::shared_ptr<State> state_{nullptr};  //! Shared by the copies of this reply.
+};
 /**
  * @class Server server.hpp.
  * @brief The Server class creates a ZMQ socket of type ZMQ_REP that accept requests from Client(s) and sends them back
@@ -27,6 +92,11 @@ namespace simple {
  * @tparam T The simple_msgs type to use.
  *
  * Implements the logic for a Server in the Client / Server paradigm.
+ * A Server given an Executor does not run its own thread, its callback runs on a thread of the Executor.
+ * A Server with more than one worker binds a ZMQ_ROUTER socket instead, the requests are distributed among the workers
+ * through a RequestBroker and the callback runs concurrently on the worker threads.
+ * A Server with deferred replies binds a ZMQ_ROUTER socket, its callback receives a DeferredReply with each request
+ * and may send the reply later from any thread. The Server keeps receiving requests meanwhile.
  */
 template <typename T>
 class Server {
@@ -44,16 +114,81 @@ public:
    * milliseconds.
    * @param [in] linger - Time the unsent messages linger in memory after the socket
    * is closed. In milliseconds. Default is -1 (infinite).
+   * @param [in] num_workers - Number of threads running the callback. With more than one worker, concurrent requests
+   * are handled in parallel and the callback has to be thread-safe.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   * @throws std::runtime_error if num_workers is 0.
    */
   explicit Server(const std::string& address, const std::function<void(T&)>& callback, int timeout = 1000,
-                  int linger = -1)
-    : socket_{new GenericSocket(zmq_socket_type::rep, T::getTopic())}, callback_{callback} {
-    socket_->setTimeout(timeout);
+                  int linger = -1, size_t num_workers = 1, const std::string& context = "")
+    : callback_{callback} {
+    if (num_workers == 0) { throw std::runtime_error("[SIMPLE Error] - A Server needs at least one worker."); }
+
+    if (num_workers == 1) {
+      socket_ = std::shared_ptr<GenericSocket>(new GenericSocket(zmq_socket_type::rep, T::getTopic(), context));
+      socket_->setTimeout(timeout);
+      socket_->setLinger(linger);
+      socket_->bind(address);
+    } else {
+      broker_ = std::make_shared<RequestBroker>(address, linger, context);
+      for (size_t i = 0; i < num_workers; ++i) {
+        auto worker = std::shared_ptr<GenericSocket>(new GenericSocket(zmq_socket_type::rep, T::getTopic(), context));
+        worker->setTimeout(timeout);
+        worker->setLinger(linger);
+        worker->setHighWaterMark(RequestBroker::worker_high_water_mark, RequestBroker::worker_high_water_mark);
+        worker->connect(broker_->workerAddress());
+        workers_.push_back(worker);
+      }
+    }
+    initServer();
+  }
+
+  /**
+   * @brief Creates a ZMQ_REP socket and connects it to the given address.
+   * The user defined callback function is responsible for taking the received request and filling it with the reply
+   * data, it runs on a thread of the given Executor.
+   * @param [in] address - address the server binds to, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>. e.g
+   * tcp://localhost:5555.
+   * @param [in] callback - user defined callback function for incoming requests.
+   * @param [in] executor - the Executor receiving the requests, it has to outlive the Server.
+   * @param [in] linger - Time the unsent messages linger in memory after the socket
+   * is closed. In milliseconds. Default is -1 (infinite).
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit Server(const std::string& address, const std::function<void(T&)>& callback, Executor& executor,
+                  int linger = -1, const std::string& context = "")
+    : socket_{new GenericSocket(zmq_socket_type::rep, T::getTopic(), context)}
+    , callback_{callback}
+    , executor_{&executor} {
     socket_->setLinger(linger);
     socket_->bind(address);
     initServer();
   }
 
+  /**
+   * @brief Creates a ZMQ_ROUTER socket and binds it to the given address.
+   * The user defined callback function receives each request together with a DeferredReply, e.g. to hand the request
+   * over to another thread and reply from there. The callback runs on the thread of the Server, while it runs no
+   * further request is received.
+   * @param [in] address - address the server binds to, in the form: \<PROTOCOL\>://\<HOSTNAME\>:\<PORT\>. e.g
+   * tcp://localhost:5555.
+   * @param [in] callback - user defined callback function for incoming requests.
+   * @param [in] linger - Time the unsent messages linger in memory after the socket
+   * is closed. In milliseconds. Default is -1 (infinite).
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit Server(const std::string& address, const std::function<void(T&, DeferredReply<T>)>& callback,
+                  int linger = -1, const std::string& context = "")
+    : router_{std::make_shared<ReplyRouter>(address, T::getTopic(), linger, context)} {
+    // The handler does not refer to the Server, the router keeps running when the Server is moved.
+    router_->start([callback](ReplyRouter& router) {
+      T msg;
+      uint64_t request_id{0};
+      if (router.receive(msg, request_id)) { callback(msg, DeferredReply<T>{router.shared_from_this(), request_id}); }
+    });
+    initServer();
+  }
+
   // A Server cannot be copied, only moved
   Server(const Server& other) = delete;
   Server& operator=(const Server& other) = delete;
@@ -61,7 +196,13 @@ public:
   /**
    * @brief Move constructor.
    */
-  Server(Server&& other) : socket_{std::move(other.socket_)}, callback_{std::move(other.callback_)} {
+  Server(Server&& other)
+    : socket_{std::move(other.socket_)}
+    , callback_{std::move(other.callback_)}
+    , executor_{other.executor_}
+    , broker_{std::move(other.broker_)}
+    , workers_{std::move(other.workers_)}
+    , router_{std::move(other.router_)} {
     other.stop();  //! The moved Server has to be stopped.
     initServer();
   }
@@ -72,9 +213,13 @@ public:
   Server& operator=(Server&& other) {
     stop();                 //! Stop the current Server object.
     if (other.isValid()) {  //! Move the Server only if it's a valid one, e.g. if it was not default constructed.
-      other.stop();         //! The moved Server has to be stopped.
+      router_ = std::move(other.router_);
+      other.stop();  //! The moved Server has to be stopped.
       socket_ = std::move(other.socket_);
+      workers_ = std::move(other.workers_);
+      broker_ = std::move(other.broker_);
       callback_ = std::move(other.callback_);
+      executor_ = other.executor_;
       initServer();
     }
     return *this;
@@ -82,13 +227,32 @@ public:
 
   ~Server() { stop(); }
 
+  /**
+   * @brief Reports the connection events of the Server, e.g. a Client connecting to it, to the given callback.
+   * @param [in] callback - called on a dedicated thread with every SocketEvent and the endpoint it refers to.
+   * @throws std::runtime_error if ZMQ cannot monitor the socket.
+   *
+   * The socket of a Server with several workers belongs to its RequestBroker, it is not monitored.
+   */
+  void setMonitor(const SocketEventCallback& callback) {
+    if (socket_ != nullptr) { socket_->setMonitor(callback, "[SIMPLE Server] - "); }
+  }
+
+  /**
+   * @brief Returns how many times the given SocketEvent happened since setMonitor() was called.
+   */
+  uint64_t eventCount(const SocketEvent& event) const { return socket_ != nullptr ? socket_->eventCount(event) : 0; }
+
   /**
    * @brief Query the endpoint that this object is bound to.
    *
    * Can be used to find the bound port if binding to ephemeral ports.
    * @return the endpoint in form of a ZMQ DSN string, i.e. "tcp://0.0.0.0:8000"
    */
-  const std::string& endpoint() { return socket_->endpoint(); }
+  const std::string& endpoint() {
+    if (router_ != nullptr) { return router_->endpoint(); }
+    return broker_ != nullptr ? broker_->endpoint() : socket_->endpoint();
+  }
 
 private:
   /**
@@ -97,7 +261,14 @@ private:
   void stop() {
     if (isValid()) {
       alive_->store(false);
+      if (registered_) {
+        executor_->remove(registration_);
+        registered_ = false;
+      }
       if (server_thread_.joinable()) { server_thread_.join(); }
+      for (auto& worker_thread : worker_threads_) { worker_thread.join(); }
+      worker_threads_.clear();
+      if (router_ != nullptr) { router_->stop(); }
     }
   }
 
@@ -107,16 +278,29 @@ private:
   inline bool isValid() const { return alive_ == nullptr ? false : alive_->load(); }
 
   /**
-   * @brief Initializes the server thread.
+   * @brief Initializes the server thread, or registers the socket to the Executor.
    */
   void initServer() {
     alive_ = std::make_shared<std::atomic<bool>>(true);
 
+    if (socket_ != nullptr && executor_ != nullptr) {
+      registration_ = executor_->add(socket_, std::bind(&Server::handleRequest, this, alive_, socket_));
+      registered_ = true;
+      return;
+    }
+
     // Start the thread of the server if not yet done. Wait for requests on the
     // dedicated thread.
     if (!server_thread_.joinable() && socket_ != nullptr) {
       server_thread_ = std::thread(&Server::awaitRequest, this, alive_, socket_);
     }
+
+    // Start one thread for each worker socket.
+    if (worker_threads_.empty()) {
+      for (const auto& worker : workers_) {
+        worker_threads_.emplace_back(&Server::awaitRequest, this, alive_, worker);
+      }
+    }
   }
 
   /**
@@ -124,12 +308,17 @@ private:
    * callback function and reply.
    */
   void awaitRequest(std::shared_ptr<std::atomic<bool>> alive, std::shared_ptr<GenericSocket> socket) {
-    while (alive->load()) {
-      T msg;
-      if (socket->receiveMsg(msg, "[SIMPLE Server] - ")) {
-        if (alive->load()) { callback_(msg); }
-        if (alive->load()) { reply(socket.get(), msg); }
-      }
+    while (alive->load()) { handleRequest(alive, socket); }
+  }
+
+  /**
+   * @brief Receives a single request, processes it using the callback function and replies.
+   */
+  void handleRequest(const std::shared_ptr<std::atomic<bool>>& alive, const std::shared_ptr<GenericSocket>& socket) {
+    T msg;
+    if (socket->receiveMsg(msg, "[SIMPLE Server] - ")) {
+      if (alive->load()) { callback_(msg); }
+      if (alive->load()) { reply(socket.get(), msg); }
     }
   }
 
@@ -142,7 +331,15 @@ private:
   std::shared_ptr<std::atomic<bool>> alive_{nullptr};  //! Flag keeping track of the internal thread's state.
   std::shared_ptr<GenericSocket> socket_{nullptr};     //! The internal socket.
   std::function<void(T&)> callback_;                   //! The callback function called at each message arrival.
+  Executor* executor_{nullptr};                        //! The Executor receiving the requests, if any.
+  size_t registration_{0};                             //! The registration of the socket to the Executor.
+  bool registered_{false};                             //! Whether the socket is registered to the Executor.
   std::thread server_thread_{};                        //! The internal Server thread on which the given callback runs.
+
+  std::shared_ptr<RequestBroker> broker_{nullptr};         //! Distributes the requests among the workers, if any.
+  std::vector<std::shared_ptr<GenericSocket>> workers_{};  //! The sockets of the workers, if any.
+  std::vector<std::thread> worker_threads_{};              //! The threads of the workers, each one runs the callback.
+  std::shared_ptr<ReplyRouter> router_{nullptr};           //! Receives the requests and sends the deferred replies.
 };
 }  // Namespace simple.
 
@@ -0,0 +1,120 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_SHARED_MEMORY_HPP
+#define SIMPLE_SHARED_MEMORY_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <simple_msgs/generic_message.hpp>
+#include <string>
+#include <vector>
+
+namespace simple {
+
+// Forward declaration.
+class SharedMemorySegment;
+
+/**
+ * @brief Identifies a payload written in a slot of a shared memory segment.
+ */
+struct SharedMemoryDescriptor {
+  std::string segment;  //! Name of the shared memory segment.
+  uint32_t slot;        //! Index of the slot within the segment.
+  uint64_t generation;  //! Generation of the slot content, it changes every time the slot is written.
+  uint64_t size;        //! Size of the payload in bytes.
+};
+
+/**
+ * @class SharedMemoryPool shared_memory.hpp.
+ * @brief A pool of slots in a POSIX shared memory segment, owned by a Publisher, to which message payloads are written.
+ *
+ * Only a SharedMemoryDescriptor of the written slot has to be transmitted to the Subscribers, which map the payload
+ * read-only through a SharedMemoryReader. A slot is reused only once every reader released it, readers that come too
+ * late for a slot that has been overwritten in the meantime get no payload.
+ * Shared memory is not supported on Windows, a std::runtime_error is thrown on construction.
+ */
+class SharedMemoryPool {
+public:
+  /**
+   * @brief Creates a pool with the given number of slots. The segment is allocated on the first use.
+   */
+  explicit SharedMemoryPool(uint32_t num_slots = 4);
+  ~SharedMemoryPool();
+
+  SharedMemoryPool(const SharedMemoryPool&) = delete;
+  SharedMemoryPool& operator=(const SharedMemoryPool&) = delete;
+
+  /**
+   * @brief Loans a free slot of at least the given size, to fill the payload in place and avoid any copy.
+   *
+   * Publishing a message whose payload is a loaned slot only transmits its descriptor. The slot is not reused as long
+   * as the returned pointer is alive, and it must not be modified after it has been published.
+   * @return nullptr if no slot is free.
+   */
+  std::shared_ptr<void> loan(uint64_t size);
+
+  /**
+   * @brief Writes the given payload to a free slot, unless it is a loaned slot already.
+   * @param [in] payload - the payload to write.
+   * @param [out] descriptor - identifies the slot that has been written.
+   * @return false if no slot is free.
+   */
+  bool write(const simple_msgs::Payload& payload, SharedMemoryDescriptor& descriptor);
+
+private:
+  /**
+   * @brief Makes sure that the segment slots can hold the given size. The mutex has to be locked.
+   */
+  void reserve(uint64_t size);
+
+  /**
+   * @brief Locks a free slot for writing and returns its index. The mutex has to be locked.
+   * @return false if no slot is free.
+   */
+  bool lockFreeSlot(uint32_t& slot);
+
+  std::mutex mutex_{};                                    //! Mutex for thread-safety.
+  uint32_t num_slots_{4};                                 //! Number of slots in the segment.
+  uint32_t next_slot_{0};                                 //! The slot to try first for the next write.
+  uint64_t generation_{0};                                //! Last generation written to a slot.
+  std::shared_ptr<SharedMemorySegment> segment_{nullptr};  //! The shared memory segment.
+  std::vector<std::weak_ptr<void>> loans_{};              //! The slots currently loaned.
+};
+
+/**
+ * @class SharedMemoryReader shared_memory.hpp.
+ * @brief Maps the payloads written by a SharedMemoryPool, possibly living in a different process.
+ */
+class SharedMemoryReader {
+public:
+  SharedMemoryReader() = default;
+  ~SharedMemoryReader();
+
+  SharedMemoryReader(const SharedMemoryReader&) = delete;
+  SharedMemoryReader& operator=(const SharedMemoryReader&) = delete;
+
+  /**
+   * @brief Returns a read-only pointer to the payload identified by the given descriptor.
+   *
+   * The slot is released when the returned pointer and all its copies are destroyed.
+   * @return nullptr if the segment does not exist anymore or if the slot has been overwritten in the meantime.
+   */
+  std::shared_ptr<const void> acquire(const SharedMemoryDescriptor& descriptor);
+
+private:
+  std::mutex mutex_{};                                           //! Mutex for thread-safety.
+  std::deque<std::shared_ptr<SharedMemorySegment>> segments_{};  //! The most recently used segments.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_SHARED_MEMORY_HPP
@@ -0,0 +1,96 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_SOCKET_MONITOR_HPP
+#define SIMPLE_SOCKET_MONITOR_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace zmq {
+class context_t;
+class socket_t;
+}  // namespace zmq
+
+namespace simple {
+
+/**
+ * @brief A change in the connections of a ZMQ socket, reported by a SocketMonitor.
+ */
+enum class SocketEvent : int {
+  connected = 0,         //! The socket connected to a peer, e.g. a Client to its Server.
+  accepted = 1,          //! A peer connected to the socket, e.g. a Subscriber to its Publisher.
+  disconnected = 2,      //! The connection to a peer was lost. A connecting socket reconnects on its own.
+  connect_retried = 3,   //! A connection attempt failed, it is retried after the reconnection interval.
+  handshake_failed = 4,  //! A peer connected, but the ZMTP handshake failed, e.g. a protocol or security mismatch.
+  count = 5              //! The number of events, not an event itself.
+};
+
+/**
+ * @brief A user callback for the events of a SocketMonitor, it receives the event and the endpoint it refers to.
+ */
+using SocketEventCallback = std::function<void(const SocketEvent& event, const std::string& endpoint)>;
+
+/**
+ * @class SocketMonitor socket_monitor.hpp.
+ * @brief The SocketMonitor class reports the connection events of a ZMQ socket, as they happen, to a user callback.
+ *
+ * It is based on zmq_socket_monitor(): ZMQ publishes the events on an inproc socket, a dedicated thread receives them,
+ * counts them and calls the callback. A failover can then react to a lost peer within milliseconds, instead of waiting
+ * for a request to time out.
+ */
+class SocketMonitor {
+public:
+  /**
+   * @brief Starts monitoring the given socket.
+   * @param [in] socket - the native handle of the ZMQ socket to monitor, it has to outlive the SocketMonitor.
+   * @param [in] context - the ZMQ context of the socket.
+   * @param [in] callback - called on the thread of the monitor for every event, it may be empty.
+   * @throws std::runtime_error if ZMQ cannot monitor the socket.
+   */
+  SocketMonitor(void* socket, zmq::context_t& context, const SocketEventCallback& callback);
+
+  /**
+   * @brief Stops monitoring the socket. It must not be used by other threads meanwhile.
+   */
+  ~SocketMonitor();
+
+  // A SocketMonitor cannot be copied nor moved, its thread refers to it.
+  SocketMonitor(const SocketMonitor&) = delete;
+  SocketMonitor& operator=(const SocketMonitor&) = delete;
+
+  /**
+   * @brief Returns how many times the given event happened since the monitor started.
+   */
+  uint64_t count(const SocketEvent& event) const;
+
+private:
+  /**
+   * @brief Receives the events published by ZMQ until the monitor is stopped.
+   */
+  void run();
+
+  void* socket_{nullptr};                                  //! The monitored socket.
+  std::unique_ptr<zmq::socket_t> events_socket_{nullptr};  //! Receives the events published by ZMQ.
+  SocketEventCallback callback_{};                         //! The user callback.
+  std::atomic<bool> alive_{true};                          //! Whether the monitor is running.
+  std::thread thread_{};                                   //! Receives the events.
+
+  // How many times each event happened, indexed by SocketEvent.
+  std::array<std::atomic<uint64_t>, static_cast<size_t>(SocketEvent::count)> counts_;
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_SOCKET_MONITOR_HPP
@@ -11,15 +11,37 @@
 #ifndef SIMPLE_SUBSCRIBER_HPP
 #define SIMPLE_SUBSCRIBER_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
 
+#include "simple/executor.hpp"
 #include "simple/generic_socket.hpp"
+#include "simple/intra_process.hpp"
+#include "simple/message_batch.hpp"
+#include "simple/poller.hpp"
+#include "simple/thread_pool.hpp"
+#include "simple/triple_buffer.hpp"
 
 namespace simple {
+
+/**
+ * @brief How a Subscriber constructed without a callback delivers the received messages.
+ */
+enum class SubscriberMode : int {
+  latest = 0,  //! A dedicated thread receives the messages and keeps only the most recent one, see getLatest().
+  polling = 1  //! No thread runs, the messages are received on the calling thread, see receive() and tryReceive().
+};
+
 /**
  *@brief Creates a subscriber socket for a specific type of message.
  */
@@ -32,6 +54,21 @@ namespace simple {
  * Implements the logic for a Subscriber in the Publisher / Subscriber paradigm. A Subscriber receives messages of type
  * T from a simple Publisher. The received messages will be passed to the callback function which is providede to the
  * Subscriber upon construction.
+ * A Subscriber connected to an address in the form inproc+direct://\<NAME\> receives the messages of a Publisher living
+ * in the same process through an IntraProcessChannel, without deserializing them.
+ * A Subscriber given an Executor does not run its own thread, its callback runs on a thread of the Executor.
+ * A Subscriber given a ThreadPool only receives the messages on its own thread, its callback runs on the pool.
+ * A Subscriber given a batch callback passes all the messages waiting after each wake up to a single call, which
+ * amortizes the cost of a call over many small high-rate messages.
+ * The messages sent by Publisher::publishBatch() are unpacked and received one by one, as if they were published
+ * separately.
+ * A Subscriber in SubscriberMode::latest has no callback, it is meant for state topics (e.g. a pose) where only the
+ * most recent value matters: whenever it is read through getLatest(), it is at most one message old, whatever the
+ * number of messages received in the meantime.
+ * Any Subscriber can also copy the most recent message to a TripleBuffer, see bufferLatest(), so that a control loop
+ * polls it through tryGetLatest() without ever waiting for the receiving thread.
+ * A Subscriber in SubscriberMode::polling has neither a callback nor a thread, e.g. for a deterministic single-threaded
+ * loop: the messages are received on the calling thread, and poll() waits on several Subscribers at once.
  */
 template <typename T>
 class Subscriber {
@@ -41,16 +78,102 @@ public:
   /**
    * @brief Creates a ZMQ_SUB socket and connects it to the given address, a Publisher is expected to be workin on that
    * address. The given callback function  runs on a dedicated thread.
-   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555.
+   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555, or
+   * inproc+direct://\<NAME\> for a Publisher living in the same process.
    * @param [in] callback - user defined callback function for incoming messages.
    * @param [in] timeout - Time the subscriber will block the thread waiting for a message. In
    * milliseconds.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit Subscriber<T>(const std::string& address, const std::function<void(const T&)>& callback, int timeout = 1000,
+                         const std::string& context = "")
+    : callback_{callback}, timeout_{timeout} {
+    open(address, context);
+    initSubscriber();
+  }
+
+  /**
+   * @brief Creates a ZMQ_SUB socket and connects it to the given address, a Publisher is expected to be workin on that
+   * address. The given callback function runs on a thread of the given Executor.
+   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555, or
+   * inproc+direct://\<NAME\> for a Publisher living in the same process.
+   * @param [in] callback - user defined callback function for incoming messages.
+   * @param [in] executor - the Executor receiving the messages, it has to outlive the Subscriber. A Subscriber on an
+   * intra-process channel does not use it and runs its own thread.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
    */
-  explicit Subscriber<T>(const std::string& address, const std::function<void(const T&)>& callback, int timeout = 1000)
-    : socket_{new GenericSocket(zmq_socket_type::sub, T::getTopic())}, callback_{callback} {
-    socket_->filter();  //! Filter the type of message that can be received, only the type T is accepted.
-    socket_->setTimeout(timeout);
-    socket_->connect(address);
+  explicit Subscriber<T>(const std::string& address, const std::function<void(const T&)>& callback, Executor& executor,
+                         const std::string& context = "")
+    : callback_{callback}, executor_{&executor} {
+    open(address, context);
+    initSubscriber();
+  }
+
+  /**
+   * @brief Creates a ZMQ_SUB socket and connects it to the given address, a Publisher is expected to be workin on that
+   * address. The messages are received on a dedicated thread, the given callback function runs on the given pool.
+   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555, or
+   * inproc+direct://\<NAME\> for a Publisher living in the same process.
+   * @param [in] callback - user defined callback function for incoming messages.
+   * @param [in] pool - the ThreadPool running the callback, it has to outlive the Subscriber.
+   * @param [in] order - CallbackOrder::fifo runs one callback at a time in the order of arrival,
+   * CallbackOrder::unordered runs them concurrently. Up to 1000 messages wait for their callback, further messages are
+   * dropped.
+   * @param [in] timeout - Time the subscriber will block the thread waiting for a message. In
+   * milliseconds.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit Subscriber<T>(const std::string& address, const std::function<void(const T&)>& callback, ThreadPool& pool,
+                         CallbackOrder order = CallbackOrder::fifo, int timeout = 1000, const std::string& context = "")
+    : callback_{callback}, timeout_{timeout}, dispatcher_{std::make_shared<CallbackDispatcher>(pool, order)} {
+    open(address, context);
+    initSubscriber();
+  }
+
+  /**
+   * @brief Creates a ZMQ_SUB socket and connects it to the given address, a Publisher is expected to be workin on that
+   * address. The given batch callback runs on a dedicated thread. Whenever a message arrives, the messages already
+   * waiting after it are received as well, without waiting for further ones, and passed to the callback at once.
+   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555, or
+   * inproc+direct://\<NAME\> for a Publisher living in the same process.
+   * @param [in] callback - user defined callback function for batches of incoming messages, in the order of arrival.
+   * The batch and its messages are reused for the next batch, they must not be kept.
+   * @param [in] max_batch_size - maximum number of messages in a batch.
+   * @param [in] timeout - Time the subscriber will block the thread waiting for a message. In
+   * milliseconds.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   *
+   * The batch callback always runs on the Subscriber thread. Every received message is part of a batch, so a batch
+   * Subscriber can neither conflate its messages nor buffer the latest one, see setBackpressure() and bufferLatest().
+   */
+  explicit Subscriber<T>(const std::string& address, const std::function<void(const MessageBatch<T>&)>& callback,
+                         size_t max_batch_size, int timeout = 1000, const std::string& context = "")
+    : timeout_{timeout}, batch_callback_{callback}, max_batch_size_{std::max<size_t>(max_batch_size, 1)} {
+    open(address, context);
+    initSubscriber();
+  }
+
+  /**
+   * @brief Creates a ZMQ_SUB socket and connects it to the given address, a Publisher is expected to be workin on that
+   * address. The messages are not passed to a callback, the given mode sets how they are received.
+   * @param [in] address - in the form \<PROTOCOL\>://\<IP_ADDRESS\>:\<PORT\>, e.g. tcp://127.0.0.1:5555, or
+   * inproc+direct://\<NAME\> for a Publisher living in the same process.
+   * @param [in] mode - SubscriberMode::latest, a dedicated thread conflates the messages and keeps only the most
+   * recent one, read through getLatest(). SubscriberMode::polling, they are received through receive() and
+   * tryReceive().
+   * @param [in] timeout - Time the subscriber will block the thread waiting for a message. In
+   * milliseconds.
+   * @param [in] context - name of the ZMQ context of the socket, see ContextManager. The default context if empty.
+   */
+  explicit Subscriber<T>(const std::string& address, const SubscriberMode& mode, int timeout = 1000,
+                         const std::string& context = "")
+    : timeout_{timeout}, mode_{mode}, keep_latest_{mode == SubscriberMode::latest} {
+    open(address, context);
+    if (keep_latest_) {
+      conflate_ = true;
+      if (queue_ != nullptr) { queue_->setLimits(1, BackpressurePolicy::drop_oldest); }
+      bufferLatest();
+    }
     initSubscriber();
   }
 
@@ -61,8 +184,27 @@ public:
   /**
    * @brief Move constructor.
    */
-  Subscriber(Subscriber&& other) : socket_{std::move(other.socket_)}, callback_{std::move(other.callback_)} {
-    other.stop();  //! The moved Subscriber has to be stopped.
+  Subscriber(Subscriber&& other)
+    : timeout_{other.timeout_}
+    , executor_{other.executor_}
+    , conflate_{other.conflate_.load()}
+    , backpressure_{other.backpressure_.load()}
+    , mode_{other.mode_}
+    , keep_latest_{other.keep_latest_}
+    , max_batch_size_{other.max_batch_size_} {
+    // The moved Subscriber has to be stopped first: its thread and the callbacks it queued on a ThreadPool still use
+    // its callbacks until then.
+    other.stop();
+    socket_ = std::move(other.socket_);
+    channel_ = std::move(other.channel_);
+    queue_ = std::move(other.queue_);
+    callback_ = std::move(other.callback_);
+    batch_callback_ = std::move(other.batch_callback_);
+    conflated_ = other.conflated_.load();
+    latest_ = std::atomic_load(&other.latest_);
+    latest_buffer_owner_ = std::move(other.latest_buffer_owner_);
+    latest_buffer_ = other.latest_buffer_.exchange(nullptr);
+    dispatcher_ = std::move(other.dispatcher_);
     initSubscriber();
   }
 
@@ -73,14 +215,33 @@ public:
     stop();                 //! Stop the current Subscriber object.
     if (other.isValid()) {  //! Move the Subscriber only if it's a valid one, e.g. if it was not default constructed.
       other.stop();         //! The moved Subscriber has to be stopped.
+      detach();
       socket_ = std::move(other.socket_);
+      channel_ = std::move(other.channel_);
+      queue_ = std::move(other.queue_);
       callback_ = std::move(other.callback_);
+      timeout_ = other.timeout_;
+      executor_ = other.executor_;
+      dispatcher_ = std::move(other.dispatcher_);
+      conflate_ = other.conflate_.load();
+      backpressure_ = other.backpressure_.load();
+      conflated_ = other.conflated_.load();
+      mode_ = other.mode_;
+      keep_latest_ = other.keep_latest_;
+      batch_callback_ = std::move(other.batch_callback_);
+      max_batch_size_ = other.max_batch_size_;
+      std::atomic_store(&latest_, std::atomic_load(&other.latest_));
+      latest_buffer_owner_ = std::move(other.latest_buffer_owner_);
+      latest_buffer_ = other.latest_buffer_.exchange(nullptr);
       initSubscriber();
     }
     return *this;
   }
 
-  ~Subscriber<T>() { stop(); }
+  ~Subscriber<T>() {
+    stop();
+    detach();
+  }
 
   /**
    * @brief Stop the subscriber loop. No further messages will be received.
@@ -90,17 +251,200 @@ public:
   inline void stop() {
     if (isValid()) {
       alive_->store(false);
+      if (registered_) {
+        executor_->remove(registration_);
+        registered_ = false;
+      }
       if (subscriber_thread_.joinable()) { subscriber_thread_.join(); }
+      if (dispatcher_ != nullptr) { dispatcher_->wait(); }  //! The callbacks still queued on the pool are skipped.
+    }
+  }
+
+  /**
+   * @brief Bounds the messages waiting to be processed and sets what happens to the ones that do not fit.
+   * @param [in] max_messages - maximum number of messages queued by ZMQ, and waiting for the callback on a ThreadPool
+   * or on an intra-process channel. 0 for no limit.
+   * @param [in] policy - BackpressurePolicy::drop_oldest conflates the queue: the older queued messages are dropped and
+   * the callback only receives the most recent one. BackpressurePolicy::drop_newest drops the new messages, or lets
+   * the Publisher drop them once the ZMQ queue is full. BackpressurePolicy::block waits for the callback to keep up,
+   * the ZMQ queue then pushes back on the Publisher, which applies its own policy.
+   *
+   * It requires ZMQ 4.2.3 or later to apply to the existing connection. Every message dropped by the Subscriber is
+   * counted, see droppedMessages(), and every message skipped in favour of a more recent one, see conflatedMessages().
+   * @throws std::runtime_error if the policy is BackpressurePolicy::drop_oldest and the Subscriber has a batch callback.
+   */
+  void setBackpressure(size_t max_messages, const BackpressurePolicy& policy = BackpressurePolicy::drop_newest) {
+    if (batch_callback_ && policy == BackpressurePolicy::drop_oldest) {
+      throw std::runtime_error("[SIMPLE Error] - A Subscriber with a batch callback cannot conflate its messages.");
+    }
+    if (socket_ != nullptr) {
+      socket_->setHighWaterMark(static_cast<int>(max_messages), static_cast<int>(max_messages));
+    }
+    if (queue_ != nullptr) { queue_->setLimits(max_messages, policy); }
+    if (dispatcher_ != nullptr) { dispatcher_->setLimits(max_messages, policy); }
+    conflate_ = policy == BackpressurePolicy::drop_oldest;
+    backpressure_ = true;
+  }
+
+  /**
+   * @brief Returns the number of messages dropped by the Subscriber because its queues were full, or because their
+   * shared memory payload had been overwritten before they were received.
+   */
+  uint64_t droppedMessages() const {
+    uint64_t dropped{0};
+    if (socket_ != nullptr) { dropped += socket_->lostPayloads(); }
+    if (queue_ != nullptr) { dropped += queue_->dropped(); }
+    if (dispatcher_ != nullptr) { dropped += dispatcher_->dropped(); }
+    return dropped;
+  }
+
+  /**
+   * @brief Returns the number of messages received but skipped by the Subscriber because a more recent one was already
+   * waiting, with BackpressurePolicy::drop_oldest or in SubscriberMode::latest. They are not counted as dropped.
+   */
+  uint64_t conflatedMessages() const { return conflated_.load(); }
+
+  /**
+   * @brief Returns the most recent message received by a Subscriber in SubscriberMode::latest.
+   * @return the message, shared with the receiving thread: it is never modified once received. A nullptr if no message
+   * has been received yet, or if the Subscriber has a callback.
+   */
+  std::shared_ptr<const T> getLatest() const { return std::atomic_load(&latest_); }
+
+  /**
+   * @brief Keeps a copy of every received message in a TripleBuffer, read through tryGetLatest(). The callback, if
+   * any, still receives all the messages. A Subscriber in SubscriberMode::latest always does so.
+   *
+   * It costs one copy of each message on the receiving thread. It has no effect if called again.
+   * @throws std::runtime_error if the Subscriber has a batch callback.
+   */
+  void bufferLatest() {
+    if (batch_callback_) {
+      throw std::runtime_error("[SIMPLE Error] - A Subscriber with a batch callback cannot buffer the latest message.");
+    }
+    if (latest_buffer_owner_ == nullptr) {
+      latest_buffer_owner_.reset(new TripleBuffer<T>{});
+      latest_buffer_.store(latest_buffer_owner_.get(), std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Copies the most recent message into the given one, if it has not been read yet. It never blocks, nor waits
+   * for the receiving thread, but it must be called by a single thread at a time. It requires bufferLatest().
+   * @param [out] msg - the most recent message.
+   * @return false if no message has been received since the last call, msg is then left untouched.
+   */
+  bool tryGetLatest(T& msg) {
+    auto buffer = latest_buffer_.load(std::memory_order_acquire);
+    return buffer != nullptr && buffer->read(msg);
+  }
+
+  /**
+   * @brief Receives a message on the calling thread, waiting for it up to the given time. Only a Subscriber in
+   * SubscriberMode::polling receives messages this way.
+   * @param [out] msg - the received message.
+   * @param [in] timeout - maximum time to wait, with millisecond resolution. 0 does not wait at all.
+   * @return false if no message was received in time.
+   */
+  bool receive(T& msg, std::chrono::microseconds timeout) {
+    if (mode_ != SubscriberMode::polling || !isValid()) { return false; }
+    if (queue_ != nullptr) {
+      std::shared_ptr<const void> shared{nullptr};
+      auto timeout_ms = static_cast<int>((std::max<int64_t>(timeout.count(), 0) + 999) / 1000);
+      if (!queue_->pop(shared, timeout_ms)) { return false; }
+      msg = *std::static_pointer_cast<const T>(shared);
+      return true;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto item = pollItem();
+    auto welcomed = socket_->isWelcomed();
+    if (poll(item, timeout) != 0 && tryReceive(msg)) { return true; }
+    if (welcomed || !socket_->isWelcomed()) { return false; }
+
+    // Only the welcome of the Publisher was received, the message may still come until the deadline.
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+    if (timeout.count() >= 0) { remaining = std::max(remaining, std::chrono::microseconds::zero()); }
+    item = pollItem();
+    return poll(item, timeout.count() < 0 ? timeout : remaining) != 0 && tryReceive(msg);
+  }
+
+  /**
+   * @brief Receives a message on the calling thread if one is already waiting, without waiting for it. Only a
+   * Subscriber in SubscriberMode::polling receives messages this way.
+   * @param [out] msg - the received message.
+   * @return false if no message was waiting.
+   */
+  bool tryReceive(T& msg) {
+    if (mode_ != SubscriberMode::polling || !isValid()) { return false; }
+    if (queue_ != nullptr) {
+      std::shared_ptr<const void> shared{nullptr};
+      if (!queue_->pop(shared, 0)) { return false; }
+      msg = *std::static_pointer_cast<const T>(shared);
+      return true;
+    }
+    // The welcome of the Publisher, or an invalid message, may come before the next message.
+    while (socket_->hasPendingMsg()) {
+      if (socket_->receiveMsg(msg, "[SIMPLE Subscriber] - ")) { return true; }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Returns what poll() waits on for this Subscriber.
+   */
+  PollItem pollItem() const {
+    PollItem item{};
+    if (socket_ != nullptr) {
+      item.socket = socket_->nativeHandle();
+      item.buffered = socket_->hasBufferedMsg();
+    }
+    item.queue = queue_;
+    return item;
+  }
+
+  /**
+   * @brief Waits until the Publisher accepted the connection of this Subscriber, instead of sleeping for a fixed time
+   * before expecting the first messages.
+   * @param [in] timeout - the maximum time to wait.
+   * @return true if the Publisher welcomed this Subscriber in time, or is bound to its intra-process channel.
+   *
+   * The Publisher welcomes its new Subscribers once it publishes or counts them, see Publisher::waitForSubscribers().
+   * The subscription reaches it right after the welcome. In SubscriberMode::polling the welcome is only received by
+   * receive() and tryReceive().
+   */
+  bool waitForPublisher(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (channel_ != nullptr ? !channel_->isBound() : (socket_ == nullptr || !socket_->isWelcomed())) {
+      if (std::chrono::steady_clock::now() >= deadline) { return false; }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+    return true;
+  }
+
+  /**
+   * @brief Reports the connection events of the Subscriber, e.g. the loss of its Publisher, to the given callback.
+   * @param [in] callback - called on a dedicated thread with every SocketEvent and the endpoint it refers to.
+   * @throws std::runtime_error if ZMQ cannot monitor the socket.
+   *
+   * The events that happened before, e.g. the first connection, are not reported. It has no effect on an intra-process
+   * channel.
+   */
+  void setMonitor(const SocketEventCallback& callback) {
+    if (socket_ != nullptr) { socket_->setMonitor(callback, "[SIMPLE Subscriber] - "); }
   }
 
+  /**
+   * @brief Returns how many times the given SocketEvent happened since setMonitor() was called.
+   */
+  uint64_t eventCount(const SocketEvent& event) const { return socket_ != nullptr ? socket_->eventCount(event) : 0; }
+
   /**
    * @brief Query the endpoint that this object is bound to.
    *
    * Can be used to find the bound port if binding to ephemeral ports.
    * @return the endpoint in form of a ZMQ DSN string, i.e. "tcp://0.0.0.0:8000"
    */
-  const std::string& endpoint() { return socket_->endpoint(); }
+  const std::string& endpoint() { return channel_ != nullptr ? channel_->address() : socket_->endpoint(); }
 
 private:
   /**
@@ -109,14 +453,53 @@ private:
   inline bool isValid() const { return alive_ == nullptr ? false : alive_->load(); }
 
   /**
-   * @brief Initializes the Subscriber thread.
+   * @brief Opens the ZMQ socket, in the given ZMQ context, or the IntraProcessChannel for the given address.
+   */
+  void open(const std::string& address, const std::string& context) {
+    if (IntraProcessChannel::isIntraProcess(address)) {
+      channel_ = IntraProcessChannel::connect(address, std::type_index(typeid(T)));
+      queue_ = std::make_shared<IntraProcessQueue>();
+      channel_->attach(queue_);
+    } else {
+      socket_ = std::shared_ptr<GenericSocket>(new GenericSocket(zmq_socket_type::sub, T::getTopic(), context));
+      socket_->filter();  //! Filter the type of message that can be received, only the type T is accepted.
+      socket_->setTimeout(timeout_);
+      socket_->connect(address);
+    }
+  }
+
+  /**
+   * @brief Initializes the Subscriber thread, or registers the socket to the Executor.
    */
   void initSubscriber() {
     alive_ = std::make_shared<std::atomic<bool>>(true);
 
+    // A polling Subscriber receives its messages on the threads calling receive() and tryReceive().
+    if (mode_ == SubscriberMode::polling) { return; }
+
+    if (socket_ != nullptr && executor_ != nullptr) {
+      registration_ = executor_->add(socket_, std::bind(&Subscriber::receiveNext, this, alive_, socket_));
+      registered_ = true;
+      return;
+    }
+
     // Start the callback thread if not yet done.
-    if (!subscriber_thread_.joinable() && socket_ != nullptr) {
-      subscriber_thread_ = std::thread(&Subscriber::subscribe, this, alive_, socket_);
+    if (!subscriber_thread_.joinable()) {
+      if (socket_ != nullptr) {
+        subscriber_thread_ = std::thread(&Subscriber::subscribe, this, alive_, socket_);
+      } else if (queue_ != nullptr) {
+        subscriber_thread_ = std::thread(&Subscriber::subscribeIntraProcess, this, alive_, queue_);
+      }
+    }
+  }
+
+  /**
+   * @brief Detaches the Subscriber from its IntraProcessChannel, if any.
+   */
+  void detach() {
+    if (channel_ != nullptr) {
+      channel_->detach(queue_);
+      channel_ = nullptr;
     }
   }
 
@@ -126,18 +509,161 @@ private:
    */
   void subscribe(std::shared_ptr<std::atomic<bool>> alive, std::shared_ptr<GenericSocket> socket) {
     while (alive->load()) {  //! Run this in a loop until the Subscriber is stopped.
-      T msg;
-      if (socket->receiveMsg(msg, "[SIMPLE Subscriber] - ")) {
-        if (alive->load()) { callback_(msg); }
+      if (batch_callback_) {
+        receiveBatch(alive, socket);
+      } else {
+        receiveNext(alive, socket);
       }
     }
   }
 
-  std::shared_ptr<std::atomic<bool>> alive_{nullptr};  //! Flag keeping track of the internal thread's state.
-  std::shared_ptr<GenericSocket> socket_{nullptr};     //! The internal socket.
-  std::function<void(const T&)> callback_{};           //! The callback function called at each message arrival.
+  /**
+   * @brief Receives a single message and calls the user callback with it.
+   */
+  void receiveNext(const std::shared_ptr<std::atomic<bool>>& alive, const std::shared_ptr<GenericSocket>& socket) {
+    T msgs[2];
+    size_t latest{0};
+    if (socket->receiveMsg(msgs[latest], "[SIMPLE Subscriber] - ")) {
+      // When conflating, the messages that are already queued make this one obsolete, only the last one is kept. The
+      // two messages take turns receiving the next one.
+      while (conflate_ && socket->hasPendingMsg()) {
+        if (!socket->receiveMsg(msgs[1 - latest], "[SIMPLE Subscriber] - ")) { break; }
+        latest = 1 - latest;
+        ++conflated_;
+      }
+      process(alive, msgs[latest]);
+    }
+
+    // The rest of a received batch is not reported by polling the socket, it is processed right away.
+    while (alive->load() && socket->hasBufferedMsg()) {
+      T next;
+      if (socket->receiveMsg(next, "[SIMPLE Subscriber] - ")) { process(alive, next); }
+    }
+  }
+
+  /**
+   * @brief Receives a message and the ones already waiting after it, up to the maximum batch size, and calls the user
+   * batch callback with all of them.
+   */
+  void receiveBatch(const std::shared_ptr<std::atomic<bool>>& alive, const std::shared_ptr<GenericSocket>& socket) {
+    batch_.clear();  //! The messages of the previous batches are reused.
+    if (!socket->receiveMsg(batch_.next(), "[SIMPLE Subscriber] - ")) { return; }
+    batch_.push();
+    while (batch_.size() < max_batch_size_ && socket->hasPendingMsg()) {
+      if (!socket->receiveMsg(batch_.next(), "[SIMPLE Subscriber] - ")) { break; }
+      batch_.push();
+    }
+    if (alive->load()) { batch_callback_(batch_); }
+  }
+
+  /**
+   * @brief Calls the user callback with a received message, or queues it on the ThreadPool.
+   */
+  void process(const std::shared_ptr<std::atomic<bool>>& alive, T& msg) {
+    auto buffer = latest_buffer_.load(std::memory_order_acquire);
+    if (buffer != nullptr) { buffer->write(msg); }
+    if (keep_latest_) {
+      std::atomic_store(&latest_, std::make_shared<const T>(std::move(msg)));
+    } else if (dispatcher_ != nullptr) {
+      dispatch(alive, std::make_shared<const T>(std::move(msg)));
+    } else if (alive->load()) {
+      callback_(msg);
+    }
+  }
+
+  /**
+   * @brief Waits for a message to be published on the IntraProcessChannel.
+   * Calls the user callback with the instance of T shared by the Publisher.
+   */
+  void subscribeIntraProcess(std::shared_ptr<std::atomic<bool>> alive, std::shared_ptr<IntraProcessQueue> queue) {
+    std::shared_ptr<const void> msg{nullptr};
+    while (alive->load()) {  //! Run this in a loop until the Subscriber is stopped.
+      if (queue->pop(msg, timeout_)) {
+        if (batch_callback_) {
+          receiveIntraProcessBatch(alive, queue, msg);
+          continue;
+        }
+        while (conflate_ && queue->pop(msg, 0)) { ++conflated_; }
+        auto buffer = latest_buffer_.load(std::memory_order_acquire);
+        if (buffer != nullptr) { buffer->write(*std::static_pointer_cast<const T>(msg)); }
+        if (keep_latest_) {
+          std::atomic_store(&latest_, std::static_pointer_cast<const T>(msg));
+        } else if (dispatcher_ != nullptr) {
+          dispatch(alive, std::static_pointer_cast<const T>(msg));
+        } else if (alive->load()) {
+          callback_(*std::static_pointer_cast<const T>(msg));
+        }
+        msg.reset();
+      }
+    }
+  }
+
+  /**
+   * @brief Copies the given message and the ones already waiting in the queue, up to the maximum batch size, and calls
+   * the user batch callback with all of them.
+   */
+  void receiveIntraProcessBatch(const std::shared_ptr<std::atomic<bool>>& alive,
+                                const std::shared_ptr<IntraProcessQueue>& queue, std::shared_ptr<const void>& msg) {
+    batch_.clear();
+    do {
+      batch_.next() = *std::static_pointer_cast<const T>(msg);
+      batch_.push();
+    } while (batch_.size() < max_batch_size_ && queue->pop(msg, 0));
+    msg.reset();
+    if (alive->load()) { batch_callback_(batch_); }
+  }
+
+  /**
+   * @brief Queues the user callback with the given message on the ThreadPool.
+   */
+  void dispatch(const std::shared_ptr<std::atomic<bool>>& alive, const std::shared_ptr<const T>& msg) {
+    auto queued = dispatcher_->post([this, alive, msg] {
+      if (alive->load()) { callback_(*msg); }
+    });
+    if (!queued && !backpressure_) {
+      std::cerr << "[SIMPLE Subscriber] - Too many messages wait for the callback, dropped one." << std::endl;
+    }
+  }
+
+  std::shared_ptr<std::atomic<bool>> alive_{nullptr};        //! Flag keeping track of the internal thread's state.
+  std::shared_ptr<GenericSocket> socket_{nullptr};           //! The internal socket.
+  std::shared_ptr<IntraProcessChannel> channel_{nullptr};    //! The channel used for intra-process subscriptions.
+  std::shared_ptr<IntraProcessQueue> queue_{nullptr};        //! The queue receiving the intra-process messages.
+  std::function<void(const T&)> callback_{};                 //! The callback function called at each message arrival.
+  int timeout_{1000};                                        //! Milliseconds the Subscriber thread waits for a message.
+  Executor* executor_{nullptr};                              //! The Executor receiving the messages, if any.
+  size_t registration_{0};                                   //! The registration of the socket to the Executor.
+  bool registered_{false};                                   //! Whether the socket is registered to the Executor.
+  std::shared_ptr<CallbackDispatcher> dispatcher_{nullptr};  //! Runs the callback on a ThreadPool, if any.
+  std::atomic<bool> conflate_{false};                        //! Whether only the most recent message is processed.
+  std::atomic<bool> backpressure_{false};                    //! Whether a BackpressurePolicy has been set.
+  std::atomic<uint64_t> conflated_{0};                       //! Number of messages skipped when conflating.
+  SubscriberMode mode_{SubscriberMode::latest};              //! How the messages are delivered without a callback.
+  bool keep_latest_{false};                                  //! Whether the messages are kept for getLatest().
+  std::shared_ptr<const T> latest_{nullptr};                 //! The most recent message, in SubscriberMode::latest.
+
+  std::function<void(const MessageBatch<T>&)> batch_callback_{};  //! The callback function called with each batch.
+  size_t max_batch_size_{1};                                      //! Maximum number of messages in a batch.
+  MessageBatch<T> batch_{};                                       //! The batch being received, reused for the next one.
+
+  std::unique_ptr<TripleBuffer<T>> latest_buffer_owner_{nullptr};  //! Owns the TripleBuffer of bufferLatest().
+  std::atomic<TripleBuffer<T>*> latest_buffer_{nullptr};           //! The TripleBuffer, read by the receiving thread.
+
   std::thread subscriber_thread_{};  //! The internal Subscriber thread on which the given callback runs.
 };
+
+/**
+ * @brief Waits until a message is waiting on any of the given Subscribers in SubscriberMode::polling, on the calling
+ * thread. The messages are then received through their tryReceive().
+ * @param [in] timeout - maximum time to wait. A negative timeout waits indefinitely, 0 does not wait at all.
+ * @param [in] subscribers - the Subscribers to wait on, of any message type.
+ * @return the number of Subscribers with a waiting message, 0 if the timeout expired.
+ */
+template <typename... Ts>
+size_t poll(std::chrono::microseconds timeout, Subscriber<Ts>&... subscribers) {
+  std::vector<PollItem> items{subscribers.pollItem()...};
+  return poll(items, timeout);
+}
 }  // Namespace simple.
 
 #endif  // SIMPLE_SUBSCRIBER_HPP
@@ -0,0 +1,159 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_THREAD_POOL_HPP
+#define SIMPLE_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "simple/backpressure.hpp"
+
+namespace simple {
+
+/**
+ * @brief In which order the callbacks of a Subscriber run on a ThreadPool.
+ */
+enum class CallbackOrder : int {
+  fifo = 0,      //! One callback at a time, in the order in which the messages have been received.
+  unordered = 1  //! Callbacks run concurrently on any thread of the pool, for stateless callbacks.
+};
+
+/**
+ * @class ThreadPool thread_pool.hpp.
+ * @brief A work-stealing pool of threads that runs the callbacks of any number of Subscribers.
+ *
+ * Every thread has its own queue of tasks. Tasks are distributed round robin among the queues, or added to the queue
+ * of the calling thread if it belongs to the pool. A thread whose queue is empty steals the most recently added task
+ * of another queue, so that all the threads keep working while there are tasks to run.
+ * Destroying a ThreadPool runs the tasks still queued. It has to outlive the Subscribers that use it.
+ */
+class ThreadPool {
+public:
+  /**
+   * @brief Creates a pool with the given number of threads, by default one for each core.
+   */
+  explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+
+  /**
+   * @brief Runs the tasks still queued and stops the threads.
+   */
+  ~ThreadPool();
+
+  // A ThreadPool cannot be copied nor moved, Subscribers keep a reference to it.
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Queues a task to run on a thread of the pool. It can be called by any thread.
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * @brief Returns the number of threads of the pool.
+   */
+  inline size_t numThreads() const { return threads_.size(); }
+
+private:
+  struct Queue {
+    std::mutex mutex{};                         //! Mutex for thread-safety.
+    std::deque<std::function<void()>> tasks{};  //! The queued tasks.
+  };
+
+  /**
+   * @brief Takes a task from the queue of the given thread, or steals one from another queue.
+   * @return false if all the queues are empty.
+   */
+  bool take(size_t index, std::function<void()>& task);
+
+  void run(size_t index);
+
+  std::vector<std::unique_ptr<Queue>> queues_{};  //! One queue for each thread.
+  std::vector<std::thread> threads_{};            //! The threads of the pool.
+  std::atomic<size_t> next_queue_{0};             //! The queue receiving the next task posted from outside the pool.
+  std::atomic<size_t> queued_{0};                 //! Number of queued tasks.
+  std::atomic<bool> alive_{true};                 //! Whether the threads have to keep running.
+  std::mutex sleep_mutex_{};                      //! Mutex for the wake up condition.
+  std::condition_variable wake_condition_{};      //! Signals the idle threads that tasks are available.
+};
+
+/**
+ * @class CallbackDispatcher thread_pool.hpp.
+ * @brief Runs the callbacks of a single Subscriber on a ThreadPool, in the given CallbackOrder.
+ *
+ * At most the given number of callbacks wait to be run, further ones are dropped as it happens for a ZMQ socket
+ * reaching its high water mark, unless another BackpressurePolicy is set.
+ */
+class CallbackDispatcher : public std::enable_shared_from_this<CallbackDispatcher> {
+public:
+  CallbackDispatcher(ThreadPool& pool, CallbackOrder order, size_t capacity = 1000);
+
+  // A CallbackDispatcher cannot be copied nor moved, its queued tasks refer to it.
+  CallbackDispatcher(const CallbackDispatcher&) = delete;
+  CallbackDispatcher& operator=(const CallbackDispatcher&) = delete;
+
+  /**
+   * @brief Queues a callback to run on the pool.
+   * @return false if too many callbacks are waiting and this one was dropped.
+   */
+  bool post(std::function<void()> callback);
+
+  /**
+   * @brief Sets the maximum number of callbacks waiting to be run and what happens to the ones that do not fit.
+   * @param [in] capacity - 0 for no limit.
+   * @param [in] policy - BackpressurePolicy::block makes post() wait for room. BackpressurePolicy::drop_oldest drops
+   * the oldest callback that is not running yet, only with CallbackOrder::fifo. Otherwise the new one is dropped.
+   */
+  void setLimits(size_t capacity, const BackpressurePolicy& policy);
+
+  /**
+   * @brief Returns the number of callbacks dropped because too many were waiting.
+   */
+  uint64_t dropped();
+
+  /**
+   * @brief Waits until all the posted callbacks have run. It returns immediately if it is called by one of them.
+   */
+  void wait();
+
+private:
+  /**
+   * @brief Runs the oldest callback of the FIFO queue, and schedules the next one.
+   */
+  void runNext();
+
+  /**
+   * @brief Runs a callback and marks it as done.
+   */
+  void run(const std::function<void()>& callback);
+
+  ThreadPool& pool_;                          //! The pool running the callbacks.
+  CallbackOrder order_{CallbackOrder::fifo};  //! The order in which the callbacks run.
+  size_t capacity_{1000};                     //! Maximum number of callbacks waiting to be run.
+  std::mutex mutex_{};                        //! Mutex for thread-safety.
+  std::condition_variable done_condition_{};  //! Signals that a callback has run.
+  std::deque<std::function<void()>> fifo_{};  //! Callbacks waiting for the previous ones, in FIFO order.
+  size_t pending_{0};                         //! Number of callbacks posted and not completed yet.
+  bool scheduled_{false};                     //! Whether a FIFO callback is queued on the pool or running.
+
+  BackpressurePolicy policy_{BackpressurePolicy::drop_newest};  //! What happens when too many callbacks wait.
+  uint64_t dropped_{0};                                         //! Number of dropped callbacks.
+};
+}  // Namespace simple.
+
+#endif  // SIMPLE_THREAD_POOL_HPP
@@ -0,0 +1,72 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SIMPLE_TRIPLE_BUFFER_HPP
+#define SIMPLE_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace simple {
+
+/**
+ * @class TripleBuffer triple_buffer.hpp.
+ * @brief Hands the most recent value over from a single writer to a single reader, without locks.
+ * @tparam T The type of the values, it has to be default constructible and copy assignable.
+ *
+ * The writer owns a back buffer and the reader a front buffer, the third one holds the last complete value. Writing
+ * and reading are wait-free: each of them fills or copies its own buffer and then swaps it with the middle one through
+ * a single atomic exchange. The writer never waits for the reader, a value that has not been read in time is replaced.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+  TripleBuffer() = default;
+
+  // A TripleBuffer cannot be copied nor moved, the writer and the reader hold a reference to it.
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  /**
+   * @brief Publishes a new value. It must be called by a single thread at a time.
+   */
+  void write(const T& value) {
+    buffers_[back_] = value;
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+  }
+
+  /**
+   * @brief Copies the most recent value, if it has not been read yet. It must be called by a single thread at a time.
+   * @return false if no value has been written since the last read, the given value is then left untouched.
+   */
+  bool read(T& value) {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) { return false; }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    value = buffers_[front_];
+    return true;
+  }
+
+private:
+  static constexpr uint8_t kIndex{0x3};  //! Bits of the middle slot holding the index of its buffer.
+  static constexpr uint8_t kFresh{0x4};  //! Bit of the middle slot set when its buffer has not been read yet.
+
+  T buffers_[3]{};                  //! The back, middle and front buffers, in any order.
+  uint8_t back_{0};                 //! The buffer being written, owned by the writer.
+  std::atomic<uint8_t> middle_{1};  //! The buffer holding the last complete value, and whether it is fresh.
+  uint8_t front_{2};                //! The buffer being read, owned by the reader.
+};
+
+template <typename T>
+constexpr uint8_t TripleBuffer<T>::kIndex;
+template <typename T>
+constexpr uint8_t TripleBuffer<T>::kFresh;
+}  // Namespace simple.
+
+#endif  // SIMPLE_TRIPLE_BUFFER_HPP
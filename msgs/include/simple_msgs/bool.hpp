@@ -100,9 +100,9 @@ protected:
   Bool& operator=(std::shared_ptr<void*> rhs) override;
 
   /**
-   * @brief Builds and returns the built buffer accordingly to the values currently stored.
+   * @brief Builds the buffer in the given builder accordingly to the values currently stored.
    */
-  std::shared_ptr<flatbuffers::DetachedBuffer> getBufferData() const override;
+  void buildBuffer(flatbuffers::FlatBufferBuilder& builder) const override;
 
 private:
   std::atomic<bool> data_{false};
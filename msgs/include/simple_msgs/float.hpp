@@ -33,10 +33,10 @@ template <>
 NumericType<float>& NumericType<float>::operator=(std::shared_ptr<void*> rhs);
 
 /**
- * @brief Builds and returns the buffer accordingly to the value currently stored.
+ * @brief Builds the buffer in the given builder accordingly to the value currently stored.
  */
 template <>
-std::shared_ptr<flatbuffers::DetachedBuffer> NumericType<float>::getBufferData() const;
+void NumericType<float>::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const;
 
 /**
  * @brief Returns an identifier of the message type generated by the flatbuffers.
@@ -11,18 +11,35 @@
 #ifndef SIMPLE_MSGS_GENERIC_MESSAGE_H
 #define SIMPLE_MSGS_GENERIC_MESSAGE_H
 
+#include <cstdint>
 #include <memory>
 
 // Forward declarations.
 namespace flatbuffers {
 class DetachedBuffer;
-}
+class FlatBufferBuilder;
+
+template <typename T>
+struct Offset;
+
+template <typename T>
+class Vector;
+}  // namespace flatbuffers
 
 namespace simple {
 class GenericSocket;
 }  // namespace simple
 
 namespace simple_msgs {
+/**
+ * @brief Bulk data of a message, e.g. the pixels of an Image, that can be transmitted outside of its Flatbuffers buffer.
+ */
+struct Payload {
+  std::shared_ptr<const void> data;  //! Pointer to the data. It keeps the data alive only if owned is true.
+  uint64_t size;                     //! Size of the data in bytes.
+  bool owned;                        //! Whether the lifetime of the data is handled by the message.
+};
+
 /**
  * @class GenericMessage generic_message.hpp.
  * @brief Base class for simple_msgs wrappers around Flatbuffers messages.
@@ -46,9 +63,46 @@ protected:
   virtual GenericMessage& operator=(std::shared_ptr<void*> rhs) = 0;
 
   /**
-   * @brief Returns the built buffer. Each simple_msgs type implements its version of it.
+   * @brief Returns the built buffer. By default it is built through buildBuffer() in a new FlatBufferBuilder.
+   */
+  virtual std::shared_ptr<flatbuffers::DetachedBuffer> getBufferData() const;
+
+  /**
+   * @brief Builds the buffer in the given builder, which has to be empty. Each simple_msgs type implements its version
+   * of it.
+   *
+   * The memory of the builder is not released afterwards, a cleared builder can be reused for other messages.
+   * By default the buffer returned by getBufferData() is copied into the builder, so that messages implementing only
+   * getBufferData() keep working. A message has to override at least one of the two methods.
+   */
+  virtual void buildBuffer(flatbuffers::FlatBufferBuilder& builder) const;
+
+  /**
+   * @brief Returns the bulk data of the message that can be transmitted outside of the Flatbuffers buffer.
+   *
+   * Messages without such data return an empty Payload, which is the default.
+   */
+  virtual Payload getPayload() const { return {}; }
+
+  /**
+   * @brief Builds the buffer without the data returned by getPayload() in the given builder.
+   */
+  virtual void buildMetadataBuffer(flatbuffers::FlatBufferBuilder& builder) const { buildBuffer(builder); }
+
+  /**
+   * @brief Sets the bulk data that has been received outside of the Flatbuffers buffer.
+   *
+   * It is called after the internal assignment operator, with memory whose lifetime is handled by the given pointer.
+   */
+  virtual void setPayload(const std::shared_ptr<const void>& /*data*/, uint64_t /*size*/) {}
+
+  /**
+   * @brief Builds a nested message, e.g. the Header of a PoseStamped, into the given builder as a vector of bytes.
+   *
+   * The nested message is built in a thread-local scratch builder, one per nesting level, whose memory is reused.
    */
-  virtual std::shared_ptr<flatbuffers::DetachedBuffer> getBufferData() const = 0;
+  static flatbuffers::Offset<flatbuffers::Vector<uint8_t>> createNestedBuffer(flatbuffers::FlatBufferBuilder& builder,
+                                                                              const GenericMessage& nested);
 };
 }  // Namespace simple_msgs.
 
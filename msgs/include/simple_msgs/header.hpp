@@ -138,9 +138,9 @@ protected:
   Header& operator=(std::shared_ptr<void*> rhs) override;
 
   /**
-   * @brief Builds and returns the buffer accordingly to the values currently stored.
+   * @brief Builds the buffer in the given builder accordingly to the values currently stored.
    */
-  std::shared_ptr<flatbuffers::DetachedBuffer> getBufferData() const override;
+  void buildBuffer(flatbuffers::FlatBufferBuilder& builder) const override;
 
 private:
   //! Thread safe copy and move constructors.
@@ -309,9 +309,32 @@ protected:
   Image& operator=(std::shared_ptr<void*> rhs) override;
 
   /**
-   * @brief Builds and returns the buffer accordingly to the values currently stored.
+   * @brief Builds the buffer in the given builder accordingly to the values currently stored.
    */
-  std::shared_ptr<flatbuffers::DetachedBuffer> getBufferData() const override;
+  void buildBuffer(flatbuffers::FlatBufferBuilder& builder) const override;
+
+  /**
+   * @brief Returns the image data, so that it can be transmitted outside of the Flatbuffers buffer.
+   */
+  Payload getPayload() const override {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (data_.empty()) { return {}; }
+    return {data_.share(), data_size_ * sizeof(T), data_.owning()};
+  }
+
+  /**
+   * @brief Builds the buffer in the given builder accordingly to the values currently stored, except for the image
+   * data.
+   */
+  void buildMetadataBuffer(flatbuffers::FlatBufferBuilder& builder) const override;
+
+  /**
+   * @brief Sets the image data received outside of the Flatbuffers buffer. The data is not copied.
+   */
+  void setPayload(const std::shared_ptr<const void>& data, uint64_t /*size*/) override {
+    std::lock_guard<std::mutex> lock{mutex_};
+    data_.setData(std::shared_ptr<const T>{data, static_cast<const T*>(data.get())});
+  }
 
 private:
   //! Thread safe copy and move constructors.
@@ -358,6 +381,14 @@ private:
 
     bool empty() const { return (owning_data_ == nullptr && not_owning_data_ == nullptr); }
 
+    bool owning() const { return owning_data_ != nullptr; }
+
+    //! Returns a pointer to the data, which keeps it alive only if the data is owned.
+    std::shared_ptr<const void> share() const {
+      if (owning_data_) { return owning_data_; }
+      return std::shared_ptr<const void>{not_owning_data_, [](const void* /*unused*/) {}};
+    }
+
     void setData(const T* data) {
       not_owning_data_ = data;
       owning_data_.reset();
@@ -378,14 +409,16 @@ private:
    */
   void fillPartialImage(const simple_msgs::ImageFbs* imageData);
 
-  std::shared_ptr<flatbuffers::DetachedBuffer> getBufferData(
-      const std::shared_ptr<flatbuffers::FlatBufferBuilder>& builder, const simple_msgs::dataTraits<T>& data_type,
-      flatbuffers::Offset<void> offset) const;
+  /**
+   * @brief Builds the buffer in the given builder with the given image data, which is left out if the offset is null.
+   */
+  void buildBuffer(flatbuffers::FlatBufferBuilder& builder, const simple_msgs::dataTraits<T>& data_type,
+                   flatbuffers::Offset<void> offset) const;
 
   /**
    * @brief Returns the image data as the correct type according to the template specialization of an Image message.
    */
-  flatbuffers::Offset<void> getDataUnionElem(std::shared_ptr<flatbuffers::FlatBufferBuilder> builder) const;
+  flatbuffers::Offset<void> getDataUnionElem(flatbuffers::FlatBufferBuilder& builder) const;
 
   mutable std::mutex mutex_{};
   simple_msgs::Header header_{};
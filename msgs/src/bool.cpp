@@ -36,12 +36,10 @@ Bool& Bool::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> Bool::getBufferData() const {
-  flatbuffers::FlatBufferBuilder builder{1024};
+void Bool::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   BoolFbsBuilder tmp_builder{builder};
   tmp_builder.add_data(data_.load());
   FinishBoolFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string Bool::getTopic() { return BoolFbsIdentifier(); }
@@ -10,9 +10,43 @@
 
 #include "simple_msgs/generic_message.hpp"
 #include <flatbuffers/flatbuffers.h>
+#include <vector>
 
 namespace simple_msgs {
 
 GenericMessage::GenericMessage() {}
 
+std::shared_ptr<flatbuffers::DetachedBuffer> GenericMessage::getBufferData() const {
+  flatbuffers::FlatBufferBuilder builder{1024};
+  buildBuffer(builder);
+  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
+}
+
+void GenericMessage::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
+  // The buffer built by the message itself is pushed as a whole, as if it had been built in the builder.
+  auto buffer = getBufferData();
+  builder.PushFlatBuffer(buffer->data(), buffer->size());
+}
+
+flatbuffers::Offset<flatbuffers::Vector<uint8_t>> GenericMessage::createNestedBuffer(
+    flatbuffers::FlatBufferBuilder& builder, const GenericMessage& nested) {
+  // Messages nest at most a few levels deep, e.g. Image -> Pose -> Point.
+  thread_local std::vector<std::unique_ptr<flatbuffers::FlatBufferBuilder>> scratch_builders{};
+  thread_local size_t depth{0};
+
+  if (scratch_builders.size() <= depth) { scratch_builders.emplace_back(new flatbuffers::FlatBufferBuilder{1024}); }
+  auto& scratch = *scratch_builders[depth];
+  scratch.Clear();
+
+  // Keeps the nesting level consistent, even if building the nested message throws.
+  struct DepthGuard {
+    size_t& level;
+    explicit DepthGuard(size_t& l) : level(l) { ++level; }
+    ~DepthGuard() { --level; }
+  } guard{depth};
+
+  nested.buildBuffer(scratch);
+  return builder.CreateVector(scratch.GetBufferPointer(), scratch.GetSize());
+}
+
 }  // namespace simple_msgs
@@ -63,16 +63,14 @@ Header& Header::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> Header::getBufferData() const {
+void Header::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
   auto frame_id_string = builder.CreateString(frame_id_);
   HeaderFbsBuilder tmp_builder{builder};
   tmp_builder.add_frame_id(frame_id_string);
   tmp_builder.add_sequence_number(seq_n_);
   tmp_builder.add_timestamp(timestamp_);
   FinishHeaderFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string Header::getTopic() { return HeaderFbsIdentifier(); }
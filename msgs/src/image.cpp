@@ -14,27 +14,23 @@
 namespace simple_msgs {
 
 template <>
-flatbuffers::Offset<void> Image<uint8_t>::getDataUnionElem(
-    std::shared_ptr<flatbuffers::FlatBufferBuilder> builder) const {
-  return Createuint8_type(*builder, builder->CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
+flatbuffers::Offset<void> Image<uint8_t>::getDataUnionElem(flatbuffers::FlatBufferBuilder& builder) const {
+  return Createuint8_type(builder, builder.CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
 }
 
 template <>
-flatbuffers::Offset<void> Image<int16_t>::getDataUnionElem(
-    std::shared_ptr<flatbuffers::FlatBufferBuilder> builder) const {
-  return Createint16_type(*builder, builder->CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
+flatbuffers::Offset<void> Image<int16_t>::getDataUnionElem(flatbuffers::FlatBufferBuilder& builder) const {
+  return Createint16_type(builder, builder.CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
 }
 
 template <>
-flatbuffers::Offset<void> Image<float>::getDataUnionElem(
-    std::shared_ptr<flatbuffers::FlatBufferBuilder> builder) const {
-  return Createfloat_type(*builder, builder->CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
+flatbuffers::Offset<void> Image<float>::getDataUnionElem(flatbuffers::FlatBufferBuilder& builder) const {
+  return Createfloat_type(builder, builder.CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
 }
 
 template <>
-flatbuffers::Offset<void> Image<double>::getDataUnionElem(
-    std::shared_ptr<flatbuffers::FlatBufferBuilder> builder) const {
-  return Createdouble_type(*builder, builder->CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
+flatbuffers::Offset<void> Image<double>::getDataUnionElem(flatbuffers::FlatBufferBuilder& builder) const {
+  return Createdouble_type(builder, builder.CreateVector(data_.getData(), static_cast<size_t>(data_size_))).Union();
 }
 
 /**
@@ -51,6 +47,8 @@ Image<uint8_t>& Image<uint8_t>::operator=(std::shared_ptr<void*> rhs) {
   if (flatbuffers::IsFieldPresent(image_data, ImageFbs::VT_IMAGE)) {
     auto local_data = (image_data->image_as_uint8_type())->raw()->data();
     data_.setData({rhs, local_data});
+  } else {
+    data_.setData(std::shared_ptr<const uint8_t>{nullptr});
   }
   return *this;
 }
@@ -69,6 +67,8 @@ Image<int16_t>& Image<int16_t>::operator=(std::shared_ptr<void*> rhs) {
   if (flatbuffers::IsFieldPresent(image_data, ImageFbs::VT_IMAGE)) {
     auto local_data = (image_data->image_as_int16_type())->raw()->data();
     data_.setData({rhs, local_data});
+  } else {
+    data_.setData(std::shared_ptr<const int16_t>{nullptr});
   }
   return *this;
 }
@@ -87,6 +87,8 @@ Image<float>& Image<float>::operator=(std::shared_ptr<void*> rhs) {
   if (flatbuffers::IsFieldPresent(image_data, ImageFbs::VT_IMAGE)) {
     auto local_data = (image_data->image_as_float_type())->raw()->data();
     data_.setData({rhs, local_data});
+  } else {
+    data_.setData(std::shared_ptr<const float>{nullptr});
   }
   return *this;
 }
@@ -105,28 +107,25 @@ Image<double>& Image<double>::operator=(std::shared_ptr<void*> rhs) {
   if (flatbuffers::IsFieldPresent(image_data, ImageFbs::VT_IMAGE)) {
     auto local_data = (image_data->image_as_double_type())->raw()->data();
     data_.setData({rhs, local_data});
+  } else {
+    data_.setData(std::shared_ptr<const double>{nullptr});
   }
   return *this;
 }
 
 template <typename T>
-std::shared_ptr<flatbuffers::DetachedBuffer> Image<T>::getBufferData(
-    const std::shared_ptr<flatbuffers::FlatBufferBuilder>& builder, const simple_msgs::dataTraits<T>& data_type,
-    flatbuffers::Offset<void> offset) const {
-  auto encoding_string = builder->CreateString(encoding_);
+void Image<T>::buildBuffer(flatbuffers::FlatBufferBuilder& builder, const simple_msgs::dataTraits<T>& data_type,
+                           flatbuffers::Offset<void> offset) const {
+  auto encoding_string = builder.CreateString(encoding_);
+  auto header_vector = createNestedBuffer(builder, header_);
+  auto origin_vector = createNestedBuffer(builder, origin_);
 
-  auto header_data = header_.getBufferData();
-  auto header_vector = builder->CreateVector(header_data->data(), header_data->size());
-
-  auto origin_data = origin_.getBufferData();
-  auto origin_vector = builder->CreateVector(origin_data->data(), origin_data->size());
-
-  ImageFbsBuilder tmp_builder{*builder};
+  ImageFbsBuilder tmp_builder{builder};
   // add the information
   tmp_builder.add_encoding(encoding_string);
   tmp_builder.add_header(header_vector);
   tmp_builder.add_origin(origin_vector);
-  if (!data_.empty()) { tmp_builder.add_image(offset); }
+  if (offset.o != 0) { tmp_builder.add_image(offset); }
   tmp_builder.add_image_type(data_type.enum_value);
   tmp_builder.add_image_size(data_size_);
   tmp_builder.add_spacing_x(spacing_x_);
@@ -136,56 +135,75 @@ std::shared_ptr<flatbuffers::DetachedBuffer> Image<T>::getBufferData(
   tmp_builder.add_width(width_);
   tmp_builder.add_depth(depth_);
   tmp_builder.add_num_channels(num_channels_);
-  FinishImageFbsBuffer(*builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder->Release());
+  FinishImageFbsBuffer(builder, tmp_builder.Finish());
 }
 
 template <>
-std::shared_ptr<flatbuffers::DetachedBuffer> Image<uint8_t>::getBufferData() const {
+void Image<uint8_t>::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  auto builder = std::make_shared<flatbuffers::FlatBufferBuilder>(1024);
 
   simple_msgs::dataTraits<uint8_t> data_type;
   flatbuffers::Offset<void> offset{};
   if (!data_.empty()) { offset = getDataUnionElem(builder); }
 
-  return getBufferData(builder, data_type, offset);
+  buildBuffer(builder, data_type, offset);
 }
 
 template <>
-std::shared_ptr<flatbuffers::DetachedBuffer> Image<int16_t>::getBufferData() const {
+void Image<int16_t>::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  auto builder = std::make_shared<flatbuffers::FlatBufferBuilder>(1024);
 
   simple_msgs::dataTraits<int16_t> data_type;
   flatbuffers::Offset<void> offset{};
   if (!data_.empty()) { offset = getDataUnionElem(builder); }
 
-  return getBufferData(builder, data_type, offset);
+  buildBuffer(builder, data_type, offset);
 }
 
 template <>
-std::shared_ptr<flatbuffers::DetachedBuffer> Image<float>::getBufferData() const {
+void Image<float>::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  auto builder = std::make_shared<flatbuffers::FlatBufferBuilder>(1024);
 
   simple_msgs::dataTraits<float> data_type;
   flatbuffers::Offset<void> offset{};
   if (!data_.empty()) { offset = getDataUnionElem(builder); }
 
-  return getBufferData(builder, data_type, offset);
+  buildBuffer(builder, data_type, offset);
 }
 
 template <>
-std::shared_ptr<flatbuffers::DetachedBuffer> Image<double>::getBufferData() const {
+void Image<double>::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  auto builder = std::make_shared<flatbuffers::FlatBufferBuilder>(1024);
 
   simple_msgs::dataTraits<double> data_type;
   flatbuffers::Offset<void> offset{};
   if (!data_.empty()) { offset = getDataUnionElem(builder); }
 
-  return getBufferData(builder, data_type, offset);
+  buildBuffer(builder, data_type, offset);
+}
+
+template <>
+void Image<uint8_t>::buildMetadataBuffer(flatbuffers::FlatBufferBuilder& builder) const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  buildBuffer(builder, simple_msgs::dataTraits<uint8_t>{}, flatbuffers::Offset<void>{});
+}
+
+template <>
+void Image<int16_t>::buildMetadataBuffer(flatbuffers::FlatBufferBuilder& builder) const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  buildBuffer(builder, simple_msgs::dataTraits<int16_t>{}, flatbuffers::Offset<void>{});
+}
+
+template <>
+void Image<float>::buildMetadataBuffer(flatbuffers::FlatBufferBuilder& builder) const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  buildBuffer(builder, simple_msgs::dataTraits<float>{}, flatbuffers::Offset<void>{});
+}
+
+template <>
+void Image<double>::buildMetadataBuffer(flatbuffers::FlatBufferBuilder& builder) const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  buildBuffer(builder, simple_msgs::dataTraits<double>{}, flatbuffers::Offset<void>{});
 }
 
 template <typename T>
@@ -31,15 +31,13 @@ NumericType<int>& NumericType<int>::operator=(std::shared_ptr<void*> rhs) {
 }
 
 /**
- * @brief Builds and returns the buffer accordingly to the value currently stored.
+ * @brief Builds the buffer in the given builder accordingly to the value currently stored.
  */
 template <>
-std::shared_ptr<flatbuffers::DetachedBuffer> NumericType<int>::getBufferData() const {
-  flatbuffers::FlatBufferBuilder builder{1024};
+void NumericType<int>::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   IntFbsBuilder tmp_builder{builder};
   tmp_builder.add_data(data_.load());
   FinishIntFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 /**
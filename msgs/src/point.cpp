@@ -155,15 +155,13 @@ Point operator/(Point lhs, const Point& rhs) {
   return lhs;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> Point::getBufferData() const {
+void Point::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
   PointFbsBuilder tmp_builder{builder};
   tmp_builder.add_x(data_[0]);
   tmp_builder.add_y(data_[1]);
   tmp_builder.add_z(data_[2]);
   FinishPointFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string Point::getTopic() { return PointFbsIdentifier(); }
@@ -61,21 +61,15 @@ PointStamped& PointStamped::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> PointStamped::getBufferData() const {
+void PointStamped::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto header_data = header_.getBufferData();
-  auto header_vector = builder.CreateVector(header_data->data(), header_data->size());
-
-  auto point_data = point_.getBufferData();
-  auto point_vector = builder.CreateVector(point_data->data(), point_data->size());
+  auto header_vector = createNestedBuffer(builder, header_);
+  auto point_vector = createNestedBuffer(builder, point_);
 
   PointStampedFbsBuilder tmp_builder{builder};
   tmp_builder.add_header(header_vector);
   tmp_builder.add_point(point_vector);
   FinishPointStampedFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string PointStamped::getTopic() { return PointStampedFbsIdentifier(); }
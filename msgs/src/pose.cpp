@@ -58,21 +58,15 @@ Pose& Pose::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> Pose::getBufferData() const {
+void Pose::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto position_data = position_.getBufferData();
-  auto position_vector = builder.CreateVector(position_data->data(), position_data->size());
-
-  auto quaternion_data = quaternion_.getBufferData();
-  auto quaternion_vector = builder.CreateVector(quaternion_data->data(), quaternion_data->size());
+  auto position_vector = createNestedBuffer(builder, position_);
+  auto quaternion_vector = createNestedBuffer(builder, quaternion_);
 
   PoseFbsBuilder tmp_builder{builder};
   tmp_builder.add_position(position_vector);
   tmp_builder.add_quaternion(quaternion_vector);
   FinishPoseFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string Pose::getTopic() { return PoseFbsIdentifier(); }
@@ -60,21 +60,15 @@ PoseStamped& PoseStamped::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> PoseStamped::getBufferData() const {
+void PoseStamped::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto header_data = header_.getBufferData();
-  auto headerVec = builder.CreateVector(header_data->data(), header_data->size());
-
-  auto pose_data = pose_.getBufferData();
-  auto poseVec = builder.CreateVector(pose_data->data(), pose_data->size());
+  auto headerVec = createNestedBuffer(builder, header_);
+  auto poseVec = createNestedBuffer(builder, pose_);
 
   PoseStampedFbsBuilder tmp_builder{builder};
   tmp_builder.add_header(headerVec);
   tmp_builder.add_pose(poseVec);
   FinishPoseStampedFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string PoseStamped::getTopic() { return PoseStampedFbsIdentifier(); }
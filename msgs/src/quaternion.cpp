@@ -78,16 +78,14 @@ Quaternion& Quaternion::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> Quaternion::getBufferData() const {
+void Quaternion::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
   QuaternionFbsBuilder tmp_builder{builder};
   tmp_builder.add_x(data_[0]);
   tmp_builder.add_y(data_[1]);
   tmp_builder.add_z(data_[2]);
   tmp_builder.add_w(data_[3]);
   FinishQuaternionFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string Quaternion::getTopic() { return QuaternionFbsIdentifier(); }
@@ -64,21 +64,15 @@ QuaternionStamped& QuaternionStamped::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> QuaternionStamped::getBufferData() const {
+void QuaternionStamped::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto header_data = header_.getBufferData();
-  auto header_vector = builder.CreateVector(header_data->data(), header_data->size());
-
-  auto quaternion_data = quaternion_.getBufferData();
-  auto quaternion_vector = builder.CreateVector(quaternion_data->data(), quaternion_data->size());
+  auto header_vector = createNestedBuffer(builder, header_);
+  auto quaternion_vector = createNestedBuffer(builder, quaternion_);
 
   QuaternionStampedFbsBuilder tmp_builder(builder);
   tmp_builder.add_header(header_vector);
   tmp_builder.add_quaternion(quaternion_vector);
   FinishQuaternionStampedFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string QuaternionStamped::getTopic() { return QuaternionStampedFbsIdentifier(); }
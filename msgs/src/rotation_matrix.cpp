@@ -87,10 +87,8 @@ RotationMatrix& RotationMatrix::operator=(std::shared_ptr<void*> data) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> RotationMatrix::getBufferData() const {
+void RotationMatrix::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
   RotationMatrixFbsBuilder tmp_builder{builder};
   tmp_builder.add_r11(data_[0]);
   tmp_builder.add_r12(data_[1]);
@@ -102,8 +100,6 @@ std::shared_ptr<flatbuffers::DetachedBuffer> RotationMatrix::getBufferData() con
   tmp_builder.add_r32(data_[7]);
   tmp_builder.add_r33(data_[8]);
   FinishRotationMatrixFbsBuffer(builder, tmp_builder.Finish());
-
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string RotationMatrix::getTopic() { return RotationMatrixFbsIdentifier(); }
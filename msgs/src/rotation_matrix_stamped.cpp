@@ -64,22 +64,15 @@ RotationMatrixStamped& RotationMatrixStamped::operator=(std::shared_ptr<void*> r
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> RotationMatrixStamped::getBufferData() const {
+void RotationMatrixStamped::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto header_data = header_.getBufferData();
-  auto header_vector = builder.CreateVector(header_data->data(), header_data->size());
-
-  auto matrix_data = rotation_matrix_.getBufferData();
-  auto matrix_vector = builder.CreateVector(matrix_data->data(), matrix_data->size());
+  auto header_vector = createNestedBuffer(builder, header_);
+  auto matrix_vector = createNestedBuffer(builder, rotation_matrix_);
 
   RotationMatrixStampedFbsBuilder tmp_builder{builder};
   tmp_builder.add_header(header_vector);
   tmp_builder.add_rotation_matrix(matrix_vector);
   FinishRotationMatrixStampedFbsBuffer(builder, tmp_builder.Finish());
-
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string RotationMatrixStamped::getTopic() { return RotationMatrixStampedFbsIdentifier(); }
@@ -70,16 +70,12 @@ String operator+(String lhs, const String& rhs) {
   return lhs;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> String::getBufferData() const {
+void String::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
   auto string_data = builder.CreateString(data_);
   StringFbsBuilder tmp_builder{builder};
   tmp_builder.add_data(string_data);
   FinishStringFbsBuffer(builder, tmp_builder.Finish());
-
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string String::getTopic() { return StringFbsIdentifier(); }
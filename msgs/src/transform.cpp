@@ -70,21 +70,15 @@ Transform& Transform::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> Transform::getBufferData() const {
+void Transform::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto point_data = point_.getBufferData();
-  auto point_vector = builder.CreateVector(point_data->data(), point_data->size());
-
-  auto matrix_data = matrix_.getBufferData();
-  auto matrix_vector = builder.CreateVector(matrix_data->data(), matrix_data->size());
+  auto point_vector = createNestedBuffer(builder, point_);
+  auto matrix_vector = createNestedBuffer(builder, matrix_);
 
   TransformFbsBuilder tmp_builder{builder};
   tmp_builder.add_point(point_vector);
   tmp_builder.add_matrix(matrix_vector);
   FinishTransformFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string Transform::getTopic() { return TransformFbsIdentifier(); }
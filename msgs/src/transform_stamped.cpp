@@ -64,21 +64,15 @@ TransformStamped& TransformStamped::operator=(std::shared_ptr<void*> rhs) {
   return *this;
 }
 
-std::shared_ptr<flatbuffers::DetachedBuffer> TransformStamped::getBufferData() const {
+void TransformStamped::buildBuffer(flatbuffers::FlatBufferBuilder& builder) const {
   std::lock_guard<std::mutex> lock{mutex_};
-  flatbuffers::FlatBufferBuilder builder{1024};
-
-  auto header_data = header_.getBufferData();
-  auto header_vector = builder.CreateVector(header_data->data(), header_data->size());
-
-  auto transform_data = transform_.getBufferData();
-  auto transform_vector = builder.CreateVector(transform_data->data(), transform_data->size());
+  auto header_vector = createNestedBuffer(builder, header_);
+  auto transform_vector = createNestedBuffer(builder, transform_);
 
   TransformStampedFbsBuilder tmp_builder{builder};
   tmp_builder.add_header(header_vector);
   tmp_builder.add_transform(transform_vector);
   FinishTransformStampedFbsBuffer(builder, tmp_builder.Finish());
-  return std::make_shared<flatbuffers::DetachedBuffer>(builder.Release());
 }
 
 std::string TransformStamped::getTopic() { return TransformStampedFbsIdentifier(); }
@@ -9,24 +9,126 @@
  */
 
 #include "simple/context_manager.hpp"
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <zmq.hpp>
 
 //! Static member are here initialized.
 std::mutex simple::ContextManager::context_mutex_{};
 std::shared_ptr<zmq::context_t> simple::ContextManager::context_{nullptr};
+std::map<std::string, std::shared_ptr<zmq::context_t>> simple::ContextManager::named_contexts_{};
+std::map<std::string, simple::ContextOptions> simple::ContextManager::options_{};
 
 namespace simple {
 
-zmq::context_t* ContextManager::instance() {
+namespace {
+// Parses an integer from the given text.
+int parseInt(const std::string& name, const std::string& text) {
+  try {
+    size_t parsed{0};
+    auto value = std::stoi(text, &parsed);
+    if (parsed == text.size()) { return value; }
+  } catch (const std::exception&) {}
+  throw std::runtime_error("[SIMPLE Error] - Invalid value \"" + text + "\" for " + name + ".");
+}
+
+// Reads an integer from the given environment variable, if it is set.
+void readEnvironment(const char* name, int& value) {
+  const char* text = std::getenv(name);
+  if (text != nullptr && *text != '\0') { value = parseInt(name, text); }
+}
+}  // namespace
+
+ContextOptions ContextOptions::fromEnvironment() {
+  ContextOptions options{};
+  readEnvironment("SIMPLE_IO_THREADS", options.io_threads);
+  readEnvironment("SIMPLE_THREAD_PRIORITY", options.thread_priority);
+  readEnvironment("SIMPLE_THREAD_SCHED_POLICY", options.thread_sched_policy);
+  readEnvironment("SIMPLE_MAX_SOCKETS", options.max_sockets);
+  readEnvironment("SIMPLE_TYPE_OF_SERVICE", options.type_of_service);
+
+  const char* affinity = std::getenv("SIMPLE_IO_THREAD_AFFINITY");
+  if (affinity != nullptr) {
+    std::stringstream cpus{affinity};
+    std::string cpu{};
+    while (std::getline(cpus, cpu, ',')) {
+      if (!cpu.empty()) { options.io_thread_affinity.push_back(parseInt("SIMPLE_IO_THREAD_AFFINITY", cpu)); }
+    }
+  }
+  return options;
+}
+
+zmq::context_t* ContextManager::instance() { return instance(""); }
+
+zmq::context_t* ContextManager::instance(const std::string& name) {
   std::lock_guard<std::mutex> lock{context_mutex_};
+  auto& context = name.empty() ? context_ : named_contexts_[name];
   // Create a new ZMQ context or return the existing one.
-  if (context_ == nullptr) { context_ = std::make_shared<zmq::context_t>(); }
-  return context_.get();
+  if (context == nullptr) {
+    auto options = options_[name];
+    if (name.empty()) {
+      // The options set explicitly take precedence over the environment.
+      auto environment = ContextOptions::fromEnvironment();
+      if (options.io_threads == -1) { options.io_threads = environment.io_threads; }
+      if (options.io_thread_affinity.empty()) { options.io_thread_affinity = environment.io_thread_affinity; }
+      if (options.thread_priority == -1) { options.thread_priority = environment.thread_priority; }
+      if (options.thread_sched_policy == -1) { options.thread_sched_policy = environment.thread_sched_policy; }
+      if (options.max_sockets == -1) { options.max_sockets = environment.max_sockets; }
+      if (options.type_of_service == -1) { options.type_of_service = environment.type_of_service; }
+    }
+
+    auto created = std::make_shared<zmq::context_t>();
+    applyOptions(*created, options);
+    options_[name] = options;
+    context = created;
+  }
+  return context.get();
+}
+
+int ContextManager::typeOfService(const std::string& name) {
+  std::lock_guard<std::mutex> lock{context_mutex_};
+  auto options = options_.find(name);
+  return options != options_.end() ? options->second.type_of_service : -1;
 }
 
 void ContextManager::destroy() {
   std::lock_guard<std::mutex> lock{context_mutex_};
+  named_contexts_.clear();
   context_ = nullptr;
 }
 
+void ContextManager::configure(const ContextOptions& options) { configure("", options); }
+
+void ContextManager::configure(const std::string& name, const ContextOptions& options) {
+  std::lock_guard<std::mutex> lock{context_mutex_};
+  auto named_context = named_contexts_.find(name);
+  auto in_use = name.empty() ? context_ != nullptr
+                             : named_context != named_contexts_.end() && named_context->second != nullptr;
+  if (in_use) {
+    throw std::runtime_error("[SIMPLE Error] - The ZMQ context is already in use, it cannot be configured anymore.");
+  }
+  options_[name] = options;
+}
+
+void ContextManager::applyOptions(zmq::context_t& context, const ContextOptions& options) {
+  // ZMQ starts the I/O threads with the first socket, the options set until then are applied to them.
+  try {
+    if (options.io_threads != -1) { context.setctxopt(ZMQ_IO_THREADS, options.io_threads); }
+    if (options.max_sockets != -1) { context.setctxopt(ZMQ_MAX_SOCKETS, options.max_sockets); }
+    if (options.thread_priority != -1) { context.setctxopt(ZMQ_THREAD_PRIORITY, options.thread_priority); }
+    if (options.thread_sched_policy != -1) { context.setctxopt(ZMQ_THREAD_SCHED_POLICY, options.thread_sched_policy); }
+#ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+    for (auto cpu : options.io_thread_affinity) { context.setctxopt(ZMQ_THREAD_AFFINITY_CPU_ADD, cpu); }
+#else
+    if (!options.io_thread_affinity.empty()) {
+      throw std::runtime_error("[SIMPLE Error] - The ZMQ version in use does not support the I/O thread affinity.");
+    }
+#endif
+  } catch (const zmq::error_t& error) {
+    throw std::runtime_error("[SIMPLE Error] - Invalid ZMQ context option. ZMQ Error: " + std::string{error.what()});
+  }
+}
+
 }  // namespace simple
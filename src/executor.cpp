@@ -0,0 +1,169 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <zmq.hpp>
+
+#include "simple/context_manager.hpp"
+#include "simple/executor.hpp"
+
+namespace simple {
+
+/**
+ * @class ExecutorThread.
+ * @brief A thread of an Executor, it polls its registered sockets and runs their handlers.
+ *
+ * The poll set is rebuilt whenever a socket is added or removed. The thread is woken up through an inproc ZMQ_PAIR
+ * socket, which is part of the poll set.
+ */
+class ExecutorThread {
+public:
+  ExecutorThread(const std::string& wake_address, const std::string& context)
+    : wake_receiver_{*ContextManager::instance(context), ZMQ_PAIR}
+    , wake_sender_{*ContextManager::instance(context), ZMQ_PAIR} {
+    wake_receiver_.bind(wake_address);
+    wake_sender_.connect(wake_address);
+    thread_ = std::thread(&ExecutorThread::run, this);
+  }
+
+  ~ExecutorThread() {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      alive_ = false;
+      wake();
+    }
+    thread_.join();
+    wake_sender_.close();
+    wake_receiver_.close();
+  }
+
+  void add(size_t id, const std::shared_ptr<GenericSocket>& socket, const std::function<void()>& handler) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    registrations_[id] = std::make_shared<Registration>(socket, handler);
+    wake();
+  }
+
+  void remove(size_t id) {
+    std::unique_lock<std::mutex> lock{mutex_};
+    auto registration = registrations_.find(id);
+    if (registration == registrations_.end()) { return; }
+    registration->second->active = false;
+    registrations_.erase(registration);
+    auto version = ++version_;
+    wake();
+
+    // Wait for the thread to rebuild its poll set, a handler that is running meanwhile completes first.
+    if (std::this_thread::get_id() != thread_.get_id()) {
+      applied_condition_.wait(lock, [this, version] { return applied_version_ >= version || !alive_; });
+    }
+  }
+
+private:
+  struct Registration {
+    Registration(const std::shared_ptr<GenericSocket>& s, const std::function<void()>& h) : socket{s}, handler{h} {}
+
+    std::shared_ptr<GenericSocket> socket;  //! The polled socket.
+    std::function<void()> handler;          //! Receives a message from the socket.
+    std::atomic<bool> active{true};         //! Whether the handler can still be called.
+  };
+
+  /**
+   * @brief Wakes the thread up from zmq_poll. The mutex has to be locked.
+   */
+  void wake() {
+    zmq::message_t signal{};
+    wake_sender_.send(signal, zmq::send_flags::dontwait);
+  }
+
+  void run() {
+    std::vector<zmq::pollitem_t> items{};
+    std::vector<std::shared_ptr<Registration>> polled{};
+
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (!alive_) { break; }
+        items.clear();
+        polled.clear();
+        items.push_back({static_cast<void*>(wake_receiver_), 0, ZMQ_POLLIN, 0});
+        for (const auto& registration : registrations_) {
+          items.push_back({registration.second->socket->nativeHandle(), 0, ZMQ_POLLIN, 0});
+          polled.push_back(registration.second);
+        }
+        applied_version_ = version_;
+      }
+      applied_condition_.notify_all();
+
+      try {
+        zmq::poll(items.data(), items.size(), -1);
+      } catch (const zmq::error_t& error) {
+        if (error.num() == ETERM) { break; }
+        std::cerr << "[SIMPLE Executor] - Failed to poll the sockets. ZMQ Error: " << error.what() << std::endl;
+        continue;
+      }
+
+      if ((items[0].revents & ZMQ_POLLIN) != 0) {
+        zmq::message_t signal{};
+        while (wake_receiver_.recv(signal, zmq::recv_flags::dontwait)) {}
+      }
+
+      for (size_t i = 1; i < items.size(); ++i) {
+        if ((items[i].revents & ZMQ_POLLIN) != 0 && polled[i - 1]->active) { polled[i - 1]->handler(); }
+      }
+    }
+
+    // Unblock the threads waiting in remove().
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      alive_ = false;
+    }
+    applied_condition_.notify_all();
+  }
+
+  std::mutex mutex_{};                                               //! Mutex for thread-safety.
+  std::condition_variable applied_condition_{};                      //! Signals a rebuilt poll set.
+  std::map<size_t, std::shared_ptr<Registration>> registrations_{};  //! The registered sockets.
+  uint64_t version_{0};                                              //! Incremented by every removal.
+  uint64_t applied_version_{0};                                      //! The version of the current poll set.
+  bool alive_{true};                                                 //! Whether the thread has to keep running.
+  zmq::socket_t wake_receiver_;                                      //! Polled to wake the thread up.
+  zmq::socket_t wake_sender_;                                        //! Wakes the thread up.
+  std::thread thread_{};                                             //! The polling thread.
+};
+
+Executor::Executor(size_t num_threads, const std::string& context) {
+  if (num_threads == 0) { throw std::runtime_error("[SIMPLE Error] - An Executor needs at least one thread."); }
+
+  // Every thread gets its own wake up address, an inproc address is not released as soon as its socket is closed.
+  static std::atomic<uint64_t> thread_counter{0};
+  for (size_t i = 0; i < num_threads; ++i) {
+    auto wake_address = "inproc://simple-executor-" + std::to_string(thread_counter++);
+    threads_.emplace_back(new ExecutorThread{wake_address, context});
+  }
+}
+
+Executor::~Executor() = default;
+
+size_t Executor::add(const std::shared_ptr<GenericSocket>& socket, const std::function<void()>& handler) {
+  auto id = next_id_++;
+  threads_[id % threads_.size()]->add(id, socket, handler);
+  return id;
+}
+
+void Executor::remove(size_t id) { threads_[id % threads_.size()]->remove(id); }
+
+}  // namespace simple
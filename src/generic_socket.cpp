@@ -8,16 +8,583 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
 #include <flatbuffers/flatbuffers.h>
+#include <simple_msgs/generated/batch_generated.h>
+#include <simple_msgs/generated/payload_generated.h>
+#include <thread>
+#include <utility>
 #include <zmq.hpp>
 
 #include "simple/generic_socket.hpp"
+#include "simple/mpsc_queue.hpp"
+#include "simple/shared_memory.hpp"
 
 namespace simple {
+/**
+ * @class BuilderPool.
+ * @brief Recycles the FlatBufferBuilders in which the sent messages are serialized.
+ *
+ * A builder is handed over to ZMQ together with the frame built in it, and it returns to the pool as soon as ZMQ
+ * releases that frame. Since FlatBufferBuilder::Clear() keeps the allocated memory, a builder that has grown to the
+ * size of the messages of a socket does not allocate anymore.
+ */
+class BuilderPool : public std::enable_shared_from_this<BuilderPool> {
+public:
+  struct Entry {
+    flatbuffers::FlatBufferBuilder builder{1024};  //! The reusable builder.
+    std::shared_ptr<BuilderPool> pool{nullptr};    //! Keeps the pool alive while the entry is in use.
+    Entry* next{nullptr};                          //! The next idle entry.
+  };
+
+  explicit BuilderPool(size_t max_idle = 64) : max_idle_{max_idle} {}
+
+  ~BuilderPool() {
+    while (idle_ != nullptr) {
+      auto next = idle_->next;
+      delete idle_;
+      idle_ = next;
+    }
+  }
+
+  BuilderPool(const BuilderPool&) = delete;
+  BuilderPool& operator=(const BuilderPool&) = delete;
+
+  /**
+   * @brief Returns an empty builder, a new one is allocated only if no idle builder is available.
+   */
+  Entry* acquire() {
+    Entry* entry{nullptr};
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (idle_ != nullptr) {
+        entry = idle_;
+        idle_ = entry->next;
+        --num_idle_;
+      }
+    }
+    if (entry == nullptr) { entry = new Entry{}; }
+    entry->next = nullptr;
+    entry->pool = shared_from_this();
+    return entry;
+  }
+
+  /**
+   * @brief Wraps the buffer finished in the given builder in a zmq::message_t without copying it. The builder returns
+   * to its pool when ZMQ releases the message.
+   */
+  static zmq::message_t toMessage(Entry* entry) {
+    // The zmq::socket_t::send() method will return as soon as the message has been queued but there are no guaranteed
+    // that the data is yet transmitted. The entry keeps the data alive until ZMQ calls the free_function.
+    auto free_function = [](void* /*unused*/, void* hint) {
+      if (hint != nullptr) {
+        auto released = static_cast<Entry*>(hint);
+        auto pool = std::move(released->pool);
+        pool->release(released);
+      }
+    };
+
+    // Initialize the message itself using the buffer data.
+    // The functor free_function is passed as the function to call when this zmq::message_t object has to be disposed.
+    // This is automatically called when the data transmission is over.
+    // The entry is passed as the pointer to use for the "hint" parameter in the free_function method.
+    return zmq::message_t{entry->builder.GetBufferPointer(), entry->builder.GetSize(), free_function, entry};
+  }
+
+private:
+  /**
+   * @brief Gives a builder back to the pool, it is deleted if enough builders are idle already.
+   */
+  void release(Entry* entry) {
+    entry->builder.Clear();
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (num_idle_ < max_idle_) {
+        entry->next = idle_;
+        idle_ = entry;
+        ++num_idle_;
+        return;
+      }
+    }
+    delete entry;
+  }
+
+  std::mutex mutex_{};    //! Mutex for thread-safety.
+  size_t max_idle_{64};   //! Maximum number of idle builders kept for reuse.
+  size_t num_idle_{0};    //! Number of idle builders.
+  Entry* idle_{nullptr};  //! List of the idle builders.
+};
+
+/**
+ * @brief The serialized frames of a message, ready to be sent after its topic.
+ */
+struct OutgoingMessage {
+  zmq::message_t data{};             //! The message data.
+  zmq::message_t descriptor{};       //! The payload descriptor, if any.
+  zmq::message_t payload{};          //! The payload, if it is sent as a separate frame.
+  bool has_descriptor{false};        //! Whether the descriptor has to be sent.
+  bool has_payload{false};           //! Whether the payload frame has to be sent after the descriptor.
+  bool has_request_id{false};        //! Whether a request envelope has to be sent before the topic.
+  uint64_t request_id{0};            //! The request id of the envelope.
+  std::vector<std::string> route{};  //! The routing envelope of a reply sent by a ZMQ_ROUTER socket, if any.
+};
+
+/**
+ * @brief The messages of a received batch, returned one at a time by GenericSocket::receiveMsg().
+ */
+struct ReceivedBatch {
+  std::shared_ptr<zmq::message_t> data{nullptr};       //! The frame holding the serialized messages.
+  std::vector<std::pair<uint64_t, uint64_t>> items{};  //! The offset and the size of each message in the frame.
+  size_t next{0};                                      //! The next message to return.
+};
+}  // namespace simple
+
+namespace {
+/**
+ * @brief Serializes a SharedMemoryDescriptor in the given builder, it is sent as an additional frame after the
+ * message data.
+ */
+void buildDescriptor(flatbuffers::FlatBufferBuilder& builder, const simple::SharedMemoryDescriptor& descriptor) {
+  auto segment = builder.CreateString(descriptor.segment);
+  auto payload = simple_msgs::CreatePayloadFbs(builder, simple_msgs::PayloadLocation_shared_memory, descriptor.size,
+                                               segment, descriptor.slot, descriptor.generation);
+  simple_msgs::FinishPayloadFbsBuffer(builder, payload);
+}
+
+/**
+ * @brief Serializes the descriptor of a payload that is sent as an additional frame after the descriptor itself.
+ */
+void buildDescriptor(flatbuffers::FlatBufferBuilder& builder, uint64_t payload_size) {
+  auto payload = simple_msgs::CreatePayloadFbs(builder, simple_msgs::PayloadLocation_zmq_frame, payload_size);
+  simple_msgs::FinishPayloadFbsBuffer(builder, payload);
+}
+
+/**
+ * @brief Every message of a batch starts at a multiple of this number of bytes, as the Flatbuffers buffers are aligned.
+ */
+const uint64_t batch_alignment{8};
+
+/**
+ * @brief Serializes the descriptor of a batch, it is sent as an additional frame after the frame holding the messages.
+ */
+void buildBatchDescriptor(flatbuffers::FlatBufferBuilder& builder, const std::vector<uint64_t>& offsets,
+                          const std::vector<uint64_t>& sizes) {
+  auto offsets_vector = builder.CreateVector(offsets);
+  auto sizes_vector = builder.CreateVector(sizes);
+  auto batch = simple_msgs::CreateBatchFbs(builder, offsets_vector, sizes_vector);
+  simple_msgs::FinishBatchFbsBuffer(builder, batch);
+}
+
+/**
+ * @brief Wraps the given buffer in a zmq::message_t without copying it, it is deleted when ZMQ releases the message.
+ */
+zmq::message_t toMessage(std::unique_ptr<std::vector<uint8_t>> buffer) {
+  auto free_function = [](void* /*unused*/, void* hint) { delete static_cast<std::vector<uint8_t>*>(hint); };
+  auto data = buffer->data();
+  auto size = buffer->size();
+  return zmq::message_t{data, size, free_function, buffer.release()};
+}
+
+/**
+ * @brief The message a ZMQ_XPUB socket sends to each new peer. It starts with a null byte, unlike any topic.
+ */
+const std::string welcome_message{"\0SIMPLE_WELCOME", 15};
+
+/**
+ * @brief Receives the pending subscription messages of a ZMQ_XPUB socket, without waiting, and counts the peers
+ * subscribed to the given topic.
+ */
+void receiveSubscriptions(zmq::socket_t& socket, const std::string& topic, std::atomic<int>& subscribers) {
+  zmq::message_t message{};
+  try {
+    while (socket.recv(message, zmq::recv_flags::dontwait)) {
+      // A subscription message is a subscribe (1) or unsubscribe (0) byte, followed by the topic filter. A peer
+      // receives the topic if the filter is a prefix of it.
+      auto data = static_cast<const char*>(message.data());
+      if (message.size() == 0 || (data[0] != 0 && data[0] != 1)) { continue; }
+      auto filter_size = message.size() - 1;
+      if (filter_size > topic.size() || topic.compare(0, filter_size, data + 1, filter_size) != 0) { continue; }
+      if (data[0] == 1) {
+        ++subscribers;
+      } else if (subscribers > 0) {
+        --subscribers;
+      }
+    }
+  } catch (const zmq::error_t& error) {
+    if (error.num() != ETERM) {
+      std::cerr << "[SIMPLE Error] - Failed to receive the subscriptions. ZMQ Error: " << error.what() << std::endl;
+    }
+  }
+}
+
+/**
+ * @brief Wraps the given payload in a zmq::message_t. Owned data is not copied, it is kept alive until ZMQ releases
+ * the message.
+ */
+zmq::message_t toMessage(const simple_msgs::Payload& payload) {
+  // Data that is not owned may be released by the user as soon as the message is sent, it has to be copied.
+  if (!payload.owned) { return zmq::message_t{payload.data.get(), static_cast<size_t>(payload.size)}; }
+
+  // Functor to call when the data transmission is over. This deletes the copy of the pointer that keeps it alive.
+  auto free_function = [](void* /*unused*/, void* hint) {
+    if (hint != nullptr) { delete static_cast<std::shared_ptr<const void>*>(hint); }
+  };
+  return zmq::message_t{const_cast<void*>(payload.data.get()), static_cast<size_t>(payload.size), free_function,
+                        new std::shared_ptr<const void>{payload.data}};
+}
+
+/**
+ * @brief Sends the topic and the frames of the given message through the socket.
+ * @throws zmq::error_t.
+ */
+void transmit(zmq::socket_t& socket, const std::string& topic, simple::OutgoingMessage& outgoing) {
+  // This is ugly, but we need a void* from the const char*.
+  auto topic_ptr = const_cast<void*>(static_cast<const void*>(topic.c_str()));
+
+  // Initialize the topic message to be sent.
+  zmq::message_t topic_message{topic_ptr, topic.size()};
+
+  // The routing envelope of a reply goes first, a ZMQ_ROUTER socket sends the reply to the peer it names.
+  if (!outgoing.route.empty()) {
+    for (const auto& frame : outgoing.route) {
+      zmq::message_t frame_message{frame.data(), frame.size()};
+      if (!socket.send(frame_message, zmq::send_flags::sndmore)) { throw zmq::error_t(); }
+    }
+    zmq::message_t delimiter{};
+    if (!socket.send(delimiter, zmq::send_flags::sndmore)) { throw zmq::error_t(); }
+  }
+
+  // The request envelope goes first: the request id and the empty delimiter that a ZMQ_REP socket expects.
+  if (outgoing.has_request_id) {
+    zmq::message_t id_message{&outgoing.request_id, sizeof(outgoing.request_id)};
+    zmq::message_t delimiter{};
+    if (!socket.send(id_message, zmq::send_flags::sndmore) || !socket.send(delimiter, zmq::send_flags::sndmore)) {
+      throw zmq::error_t();
+    }
+  }
+
+  // Send the topic first and add the rest of the message after it. If the topic cannot be sent, e.g. a ZMQ_XPUB socket
+  // reached its high water mark, nothing has been sent and the message can be sent again.
+  if (!socket.send(topic_message, zmq::send_flags::sndmore)) { throw zmq::error_t(); }
+  auto message_success =
+      socket.send(outgoing.data, outgoing.has_descriptor ? zmq::send_flags::sndmore : zmq::send_flags::dontwait);
+
+  // If something wrong happened, throw zmq::error_t().
+  if (message_success.value() == false) { throw zmq::error_t(); }
+
+  if (outgoing.has_descriptor) {
+    auto flags = outgoing.has_payload ? zmq::send_flags::sndmore : zmq::send_flags::dontwait;
+    if (socket.send(outgoing.descriptor, flags).value() == false) { throw zmq::error_t(); }
+  }
+
+  if (outgoing.has_payload) {
+    if (socket.send(outgoing.payload, zmq::send_flags::dontwait).value() == false) { throw zmq::error_t(); }
+  }
+}
+}  // namespace
+
+namespace simple {
+
+/**
+ * @class AsyncSender.
+ * @brief Sends the messages queued by any number of threads through a ZMQ socket, from a dedicated I/O thread.
+ *
+ * Producers only pay for a wait-free push on an MpscQueue. The I/O thread sleeps on a condition variable when there
+ * is nothing to send, producers take its mutex only to wake it up.
+ * The queue is bounded in messages and in bytes, the BackpressurePolicy sets what happens when it is full. With
+ * BackpressurePolicy::drop_oldest producers never wait, the I/O thread drops the oldest messages while the queue is
+ * over its limits.
+ * With coalescing enabled, the I/O thread gathers the messages that arrive within a short window into a single batch
+ * frame, as GenericSocket::sendBatch() does. Messages with a payload frame or a request envelope are sent on their own.
+ */
+class AsyncSender {
+public:
+  AsyncSender(zmq::socket_t& socket, const std::string& topic, const std::shared_ptr<std::atomic<int>>& subscribers,
+              size_t capacity, const std::string& custom_error, size_t max_bytes = 0,
+              BackpressurePolicy policy = BackpressurePolicy::drop_newest, bool report_drops = true)
+    : socket_(socket)
+    , topic_{topic}
+    , subscribers_{subscribers}
+    , custom_error_{custom_error}
+    , capacity_{capacity}
+    , max_bytes_{max_bytes}
+    , policy_{policy}
+    , report_drops_{report_drops} {
+    thread_ = std::thread(&AsyncSender::run, this);
+  }
+
+  /**
+   * @brief Stops the I/O thread once all the queued messages have been sent.
+   */
+  ~AsyncSender() {
+    alive_ = false;
+    wake();
+    thread_.join();
+  }
+
+  /**
+   * @brief Queues a message to be sent. It can be called concurrently by any number of threads.
+   * @return false if the queue is full and the message was dropped.
+   */
+  bool push(OutgoingMessage&& outgoing) {
+    auto size = sizeOf(outgoing);
+    if (policy_ == BackpressurePolicy::drop_oldest) {
+      // The message is always queued, the I/O thread drops the oldest ones if the queue is over its limits.
+      pending_ += 1;
+      pending_bytes_ += size;
+    } else {
+      while (!reserve(size)) {
+        if (policy_ == BackpressurePolicy::drop_newest || !alive_) {
+          ++dropped_;
+          return false;
+        }
+        // Wait for the I/O thread to free some room, it notifies only the producers that are waiting.
+        std::unique_lock<std::mutex> lock{space_mutex_};
+        ++waiting_;
+        space_condition_.wait_for(lock, std::chrono::milliseconds(10));
+        --waiting_;
+      }
+    }
+    queue_.push(std::move(outgoing));
+    wake();
+    return true;
+  }
+
+  /**
+   * @brief Returns the number of messages dropped because the queue was full.
+   */
+  inline uint64_t dropped() const { return dropped_; }
+
+  /**
+   * @brief Returns whether a dropped message has to be reported, rather than only counted.
+   */
+  inline bool reportDrops() const { return report_drops_; }
+
+  /**
+   * @brief Sets how long a message may wait for others to be coalesced with it, and the size at which a batch is sent
+   * right away. A zero delay disables coalescing.
+   */
+  void setCoalescing(std::chrono::microseconds max_delay, size_t max_bytes) {
+    coalescing_bytes_ = max_bytes;
+    coalescing_delay_ = max_delay.count();
+    wake();
+  }
+
+  inline std::chrono::microseconds coalescingDelay() const { return std::chrono::microseconds(coalescing_delay_); }
+  inline size_t coalescingBytes() const { return coalescing_bytes_; }
+  inline size_t capacity() const { return capacity_; }
+  inline size_t maxBytes() const { return max_bytes_; }
+  inline BackpressurePolicy policy() const { return policy_; }
+
+private:
+  static size_t sizeOf(const OutgoingMessage& outgoing) {
+    return outgoing.data.size() + outgoing.descriptor.size() + outgoing.payload.size();
+  }
+
+  /**
+   * @brief Reserves room in the queue for a message of the given size. A message larger than max_bytes_ fits in an
+   * empty queue.
+   */
+  bool reserve(size_t size) {
+    if (pending_.fetch_add(1) >= capacity_) {
+      pending_.fetch_sub(1);
+      return false;
+    }
+    auto queued_bytes = pending_bytes_.fetch_add(size);
+    if (max_bytes_ != 0 && queued_bytes != 0 && queued_bytes + size > max_bytes_) {
+      pending_bytes_.fetch_sub(size);
+      pending_.fetch_sub(1);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Frees the room of the messages that have been sent or dropped.
+   */
+  void release(size_t size, size_t count = 1) {
+    pending_bytes_ -= size;
+    pending_ -= count;
+    if (waiting_ > 0) {
+      std::lock_guard<std::mutex> lock{space_mutex_};
+      space_condition_.notify_all();
+    }
+  }
+
+  bool overLimits() const {
+    return pending_ > capacity_ || (max_bytes_ != 0 && pending_ > 1 && pending_bytes_ > max_bytes_);
+  }
+
+  void wake() {
+    if (sleeping_.exchange(false)) {
+      std::lock_guard<std::mutex> lock{wake_mutex_};
+      wake_condition_.notify_one();
+    }
+  }
+
+  void run() {
+    OutgoingMessage outgoing;
+    while (alive_ || pending_ > 0) {
+      if (queue_.pop(outgoing)) {
+        if (coalescing_delay_ > 0 && !outgoing.has_descriptor && !outgoing.has_request_id && outgoing.route.empty()) {
+          coalesce(outgoing);
+        } else {
+          flush();  //! The messages are sent in order.
+          auto size = sizeOf(outgoing);
+          send(outgoing);
+          release(size);
+        }
+        outgoing = OutgoingMessage{};
+        continue;
+      }
+
+      // The coalesced messages are sent once their delay expired, or right away when stopping.
+      auto sleep_time = std::chrono::microseconds{std::chrono::milliseconds(10)};
+      if (coalesced_count_ > 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(coalesced_deadline_ - Clock::now());
+        if (!alive_ || remaining.count() <= 0) {
+          flush();
+          continue;
+        }
+        sleep_time = std::min(sleep_time, remaining);
+      }
+
+      // The subscriptions of a ZMQ_XPUB socket are counted while the socket is idle.
+      if (subscribers_ != nullptr) { receiveSubscriptions(socket_, topic_, *subscribers_); }
+
+      // Nothing to send: sleep until a producer wakes the thread up. A message that is still being pushed is counted
+      // as pending already, the timeout covers the short window in which it is not linked to the queue yet.
+      std::unique_lock<std::mutex> lock{wake_mutex_};
+      sleeping_ = true;
+      if (alive_ && pending_ == coalesced_count_) { wake_condition_.wait_for(lock, sleep_time); }
+      sleeping_ = false;
+    }
+  }
+
+  /**
+   * @brief Adds a message to the batch being coalesced, the batch is sent once it reaches the maximum size.
+   */
+  void coalesce(OutgoingMessage& outgoing) {
+    coalesced_size_ += sizeOf(outgoing);
+    if (coalesced_count_++ == 0) {
+      // A single message is sent as it is, it is copied to a batch only once a second one arrives.
+      coalesced_first_ = std::move(outgoing);
+      coalesced_deadline_ = Clock::now() + std::chrono::microseconds(coalescing_delay_.load());
+    } else {
+      if (coalesced_count_ == 2) {
+        coalesced_data_.reset(new std::vector<uint8_t>{});
+        coalesced_offsets_.clear();
+        coalesced_sizes_.clear();
+        append(coalesced_first_.data);
+        coalesced_first_ = OutgoingMessage{};
+      }
+      append(outgoing.data);
+    }
+    if (coalesced_size_ >= coalescing_bytes_) { flush(); }
+  }
+
+  /**
+   * @brief Copies the data of a message to the batch being coalesced, aligned as the Flatbuffers buffers require.
+   */
+  void append(const zmq::message_t& data) {
+    auto offset = (coalesced_data_->size() + batch_alignment - 1) / batch_alignment * batch_alignment;
+    coalesced_data_->resize(offset + data.size());
+    std::memcpy(coalesced_data_->data() + offset, data.data(), data.size());
+    coalesced_offsets_.push_back(offset);
+    coalesced_sizes_.push_back(data.size());
+  }
+
+  /**
+   * @brief Sends the coalesced messages, if any.
+   */
+  void flush() {
+    if (coalesced_count_ == 0) { return; }
+    if (coalesced_count_ == 1) {
+      send(coalesced_first_);
+      coalesced_first_ = OutgoingMessage{};
+    } else {
+      OutgoingMessage batch{};
+      batch.data = toMessage(std::move(coalesced_data_));
+      descriptor_builder_.Clear();
+      buildBatchDescriptor(descriptor_builder_, coalesced_offsets_, coalesced_sizes_);
+      batch.descriptor = zmq::message_t{descriptor_builder_.GetBufferPointer(), descriptor_builder_.GetSize()};
+      batch.has_descriptor = true;
+      send(batch, coalesced_count_);
+    }
+    release(coalesced_size_, coalesced_count_);
+    coalesced_count_ = 0;
+    coalesced_size_ = 0;
+  }
+
+  /**
+   * @brief Sends the given number of messages, as a single one or as a batch. While a peer does not keep up the send is
+   * retried, unless the messages have to be dropped.
+   */
+  void send(OutgoingMessage& outgoing, size_t count = 1) {
+    while (true) {
+      if (policy_ == BackpressurePolicy::drop_oldest && overLimits()) {
+        dropped_ += count;
+        return;
+      }
+      try {
+        transmit(socket_, topic_, outgoing);
+        return;
+      } catch (const zmq::error_t& error) {
+        if (error.num() != EAGAIN) {
+          std::cerr << custom_error_ << "Failed to send the message. ZMQ Error: " << error.what() << std::endl;
+          return;
+        }
+        // The send timed out. When stopping, the messages that cannot be sent are dropped.
+        if (!alive_) {
+          dropped_ += count;
+          return;
+        }
+      }
+    }
+  }
+
+  zmq::socket_t& socket_;                                       //! The socket, owned by the GenericSocket.
+  std::string topic_{""};                                       //! The topic sent before each message.
+  std::shared_ptr<std::atomic<int>> subscribers_{nullptr};      //! Subscribed peers of a ZMQ_XPUB socket, if any.
+  std::string custom_error_{""};                                //! Prefix of the error messages.
+  size_t capacity_{1000};                                       //! Maximum number of queued messages.
+  size_t max_bytes_{0};                                         //! Maximum size of the queued messages, 0 for any.
+  BackpressurePolicy policy_{BackpressurePolicy::drop_newest};  //! What happens when the queue is full.
+  bool report_drops_{true};                                     //! Whether the dropped messages are reported.
+  MpscQueue<OutgoingMessage> queue_{};                          //! The messages waiting to be sent.
+  std::atomic<size_t> pending_{0};                              //! Number of messages pushed and not sent yet.
+  std::atomic<size_t> pending_bytes_{0};                        //! Size of the messages pushed and not sent yet.
+  std::atomic<uint64_t> dropped_{0};                            //! Number of messages dropped.
+  std::atomic<bool> alive_{true};                               //! Whether the I/O thread has to keep running.
+  std::atomic<bool> sleeping_{false};                           //! Whether the I/O thread is waiting for messages.
+  std::mutex wake_mutex_{};                                     //! Mutex for the wake up condition.
+  std::condition_variable wake_condition_{};                    //! Signals the I/O thread that messages are available.
+  std::atomic<int> waiting_{0};                                 //! Number of producers waiting for room.
+  std::mutex space_mutex_{};                                    //! Mutex for the room condition.
+  std::condition_variable space_condition_{};                   //! Signals the producers that room is available.
+  std::thread thread_{};                                        //! The I/O thread.
+
+  using Clock = std::chrono::steady_clock;
+  std::atomic<int64_t> coalescing_delay_{0};                //! Microseconds a message may wait, 0 for no coalescing.
+  std::atomic<size_t> coalescing_bytes_{0};                 //! Size at which the coalesced messages are sent.
+  OutgoingMessage coalesced_first_{};                       //! The first coalesced message, while it is alone.
+  std::unique_ptr<std::vector<uint8_t>> coalesced_data_{};  //! The data of the coalesced messages.
+  std::vector<uint64_t> coalesced_offsets_{};               //! The offset of each coalesced message in the data.
+  std::vector<uint64_t> coalesced_sizes_{};                 //! The size of each coalesced message in the data.
+  size_t coalesced_count_{0};                               //! Number of coalesced messages.
+  size_t coalesced_size_{0};                                //! Size of the coalesced messages, as they were queued.
+  Clock::time_point coalesced_deadline_{};                  //! When the coalesced messages have to be sent.
+  flatbuffers::FlatBufferBuilder descriptor_builder_{};     //! Builds the descriptor of the coalesced batches.
+};
 
 GenericSocket::GenericSocket() : socket_{nullptr} {}
 
-GenericSocket::GenericSocket(const zmq_socket_type& type, const std::string& topic) : topic_{topic} {
+GenericSocket::GenericSocket(const zmq_socket_type& type, const std::string& topic, const std::string& context)
+  : topic_{topic}, context_{context} {
   initSocket(type);
 }
 
@@ -29,10 +596,24 @@ GenericSocket::GenericSocket(GenericSocket&& other) noexcept {
   std::lock(mutex_, other.mutex_);
   std::lock_guard<std::mutex> lock{mutex_, std::adopt_lock};
   std::lock_guard<std::mutex> other_lock{other.mutex_, std::adopt_lock};
+  std::lock(monitor_mutex_, other.monitor_mutex_);
+  std::lock_guard<std::mutex> monitor_lock{monitor_mutex_, std::adopt_lock};
+  std::lock_guard<std::mutex> other_monitor_lock{other.monitor_mutex_, std::adopt_lock};
   socket_ = std::move(other.socket_);
   other.socket_ = nullptr;
   topic_ = std::move(other.topic_);
+  context_ = std::move(other.context_);
   endpoint_ = std::move(other.endpoint_);
+  shared_memory_pool_ = std::move(other.shared_memory_pool_);
+  shared_memory_reader_ = std::move(other.shared_memory_reader_);
+  async_sender_ = std::move(other.async_sender_);
+  builder_pool_ = std::move(other.builder_pool_);
+  payload_transport_ = other.payload_transport_;
+  received_batch_ = std::move(other.received_batch_);
+  subscribers_ = std::move(other.subscribers_);
+  welcomed_ = other.welcomed_.load();
+  lost_payloads_ = other.lost_payloads_.load();
+  monitor_ = std::move(other.monitor_);
 }
 
 GenericSocket& GenericSocket::operator=(GenericSocket&& other) noexcept {
@@ -40,10 +621,27 @@ GenericSocket& GenericSocket::operator=(GenericSocket&& other) noexcept {
   std::lock_guard<std::mutex> lock{mutex_, std::adopt_lock};
   std::lock_guard<std::mutex> other_lock{other.mutex_, std::adopt_lock};
   if (other.isSocketValid()) {
+    // The I/O thread and the monitor of this socket, if any, are stopped before the socket is replaced, as when it is
+    // closed.
+    async_sender_ = std::move(other.async_sender_);
+    std::lock(monitor_mutex_, other.monitor_mutex_);
+    std::lock_guard<std::mutex> monitor_lock{monitor_mutex_, std::adopt_lock};
+    std::lock_guard<std::mutex> other_monitor_lock{other.monitor_mutex_, std::adopt_lock};
+    monitor_ = nullptr;
     socket_ = std::move(other.socket_);
     other.socket_ = nullptr;
     topic_ = std::move(other.topic_);
+    context_ = std::move(other.context_);
     endpoint_ = std::move(other.endpoint_);
+    shared_memory_pool_ = std::move(other.shared_memory_pool_);
+    shared_memory_reader_ = std::move(other.shared_memory_reader_);
+    builder_pool_ = std::move(other.builder_pool_);
+    payload_transport_ = other.payload_transport_;
+    received_batch_ = std::move(other.received_batch_);
+    subscribers_ = std::move(other.subscribers_);
+    welcomed_ = other.welcomed_.load();
+    lost_payloads_ = other.lost_payloads_.load();
+    monitor_ = std::move(other.monitor_);
   }
   return *this;
 }
@@ -78,44 +676,77 @@ bool GenericSocket::sendMsg(const simple_msgs::GenericMessage& msg, const std::s
   // Early return if socket_ has not been created yet.
   if (socket_ == nullptr) { return false; }
 
-  std::lock_guard<std::mutex> lock{mutex_};
+  // Nobody would receive the message.
+  if (!maySendToSubscribers()) { return true; }
 
-  try {
-    // This is ugly, but we need a void* from the const char*.
-    auto topic_ptr = const_cast<void*>(static_cast<const void*>(topic_.c_str()));
+  // The message is serialized on the calling thread, concurrent senders do not wait on each other meanwhile.
+  OutgoingMessage outgoing;
+  serialize(msg, outgoing, custom_error);
+  return send(outgoing, custom_error);
+}
 
-    // Initialize the topic message to be sent.
-    zmq::message_t topic_message{topic_ptr, topic_.size()};
+bool GenericSocket::sendMsg(const simple_msgs::GenericMessage& msg, uint64_t request_id,
+                            const std::string& custom_error) const {
+  // Early return if socket_ has not been created yet.
+  if (socket_ == nullptr) { return false; }
 
-    auto buffer = msg.getBufferData();
+  OutgoingMessage outgoing;
+  serialize(msg, outgoing, custom_error);
+  outgoing.has_request_id = true;
+  outgoing.request_id = request_id;
+  return send(outgoing, custom_error);
+}
 
-    // Create a shared_ptr to the given buffer data, this allows to avoid disposing the data to be sent before the
-    // actual transmission is terminated. The zmq::socket_t::send() method will return as soon as the message has been
-    // queued but there are no guaranteed that the data is yet transmitted. This pointer will keep the data alive and
-    // dispose it when not necessary anymore.
-    auto buffer_pointer = new std::shared_ptr<flatbuffers::DetachedBuffer>{buffer};
+bool GenericSocket::sendMsg(const simple_msgs::GenericMessage& msg, const std::vector<std::string>& envelope,
+                            const std::string& custom_error) const {
+  // Early return if socket_ has not been created yet.
+  if (socket_ == nullptr) { return false; }
 
-    // Functor to call when the data transmission is over. This deletes the buffer_pointer object.
-    auto free_function = [](void* /*unused*/, void* hint) {
-      if (hint != nullptr) {
-        auto b = static_cast<std::shared_ptr<flatbuffers::DetachedBuffer>*>(hint);
-        delete b;
-      }
-    };
+  OutgoingMessage outgoing;
+  serialize(msg, outgoing, custom_error);
+  outgoing.route = envelope;
+  return send(outgoing, custom_error);
+}
 
-    // Initialize the message itself using the buffer data.
-    // The functor free_function is passed as the function to call when this zmq::message_t object has to be disposed.
-    // This is automatically called when the data transmission is over.
-    // buffer_pointer is passed as the pointer to use for the "hint" parameter in the free_function method.
-    zmq::message_t message{buffer->data(), buffer->size(), free_function, buffer_pointer};
+bool GenericSocket::sendBatch(const std::vector<const simple_msgs::GenericMessage*>& messages,
+                              const std::string& custom_error) const {
+  // Early return if socket_ has not been created yet.
+  if (socket_ == nullptr) { return false; }
+  if (messages.empty() || !maySendToSubscribers()) { return true; }
+
+  OutgoingMessage outgoing;
+  serializeBatch(messages, outgoing);
+  return send(outgoing, custom_error);
+}
+
+bool GenericSocket::maySendToSubscribers() const {
+  // Publishing to subscribers costs no lock, the subscriptions are received along with the message in send().
+  return subscribers_ == nullptr || subscribers_->load() > 0 || subscriberCount() > 0;
+}
+
+bool GenericSocket::send(OutgoingMessage& outgoing, const std::string& custom_error) const {
+  // In asynchronous mode the message is handed over to the I/O thread.
+  if (async_sender_ != nullptr) {
+    if (!async_sender_->push(std::move(outgoing))) {
+      // Drops are only counted once a policy has been set, the user expects them.
+      if (async_sender_->reportDrops()) {
+        std::cerr << custom_error << "Failed to send the message. The send queue is full." << std::endl;
+      }
+      return false;
+    }
+    return true;
+  }
 
-    // Send the topic first and add the rest of the message after it.
-    auto topic_success = socket_->send(topic_message, zmq::send_flags::sndmore);
-    auto message_success = socket_->send(message, zmq::send_flags::dontwait);
+  std::lock_guard<std::mutex> lock{mutex_};
 
-    // If something wrong happened, throw zmq::error_t().
-    if (topic_success.value() == false || message_success.value() == false) { throw zmq::error_t(); }
+  // The last subscriber may have left since the message was serialized.
+  if (subscribers_ != nullptr) {
+    receiveSubscriptions(*socket_, topic_, *subscribers_);
+    if (subscribers_->load() == 0) { return true; }
+  }
 
+  try {
+    transmit(*socket_, topic_, outgoing);
   } catch (const zmq::error_t& error) {
     std::cerr << custom_error << "Failed to send the message. ZMQ Error: " << error.what() << std::endl;
     return false;
@@ -125,11 +756,105 @@ bool GenericSocket::sendMsg(const simple_msgs::GenericMessage& msg, const std::s
   return true;
 }
 
+void GenericSocket::serialize(const simple_msgs::GenericMessage& msg, OutgoingMessage& outgoing,
+                              const std::string& custom_error) const {
+  if (payload_transport_ == PayloadTransport::zmq_frame) {
+    // The payload travels as an additional frame after its descriptor, without being copied into the message data.
+    auto payload = msg.getPayload();
+    if (payload.data != nullptr) {
+      auto entry = builder_pool_->acquire();
+      buildDescriptor(entry->builder, payload.size);
+      outgoing.descriptor = BuilderPool::toMessage(entry);
+      outgoing.payload = toMessage(payload);
+      outgoing.has_descriptor = true;
+      outgoing.has_payload = true;
+    }
+  } else if (shared_memory_pool_ != nullptr) {
+    // With shared memory, the payload is written to a slot and only its descriptor travels after the message data.
+    // If no slot is available or no segment can be created, the whole message is serialized as usual.
+    auto payload = msg.getPayload();
+    SharedMemoryDescriptor slot{};
+    bool written{false};
+    if (payload.data != nullptr) {
+      try {
+        written = shared_memory_pool_->write(payload, slot);
+      } catch (const std::runtime_error& error) {
+        std::cerr << custom_error << "Failed to write the payload to shared memory, it is sent inline. "
+                  << error.what() << std::endl;
+      }
+    }
+    if (written) {
+      auto entry = builder_pool_->acquire();
+      buildDescriptor(entry->builder, slot);
+      outgoing.descriptor = BuilderPool::toMessage(entry);
+      outgoing.has_descriptor = true;
+    }
+  }
+
+  // The message is built in a recycled builder, which is handed over to ZMQ without copying the buffer.
+  auto entry = builder_pool_->acquire();
+  if (outgoing.has_descriptor) {
+    msg.buildMetadataBuffer(entry->builder);
+  } else {
+    msg.buildBuffer(entry->builder);
+  }
+  outgoing.data = BuilderPool::toMessage(entry);
+}
+
+void GenericSocket::serializeBatch(const std::vector<const simple_msgs::GenericMessage*>& messages,
+                                   OutgoingMessage& outgoing) const {
+  // Every message is serialized in the same recycled builder and copied to the frame of the batch.
+  std::unique_ptr<std::vector<uint8_t>> data{new std::vector<uint8_t>{}};
+  std::vector<uint64_t> offsets{};
+  std::vector<uint64_t> sizes{};
+  offsets.reserve(messages.size());
+  sizes.reserve(messages.size());
+
+  auto entry = builder_pool_->acquire();
+  for (const auto msg : messages) {
+    entry->builder.Clear();
+    msg->buildBuffer(entry->builder);
+    auto offset = (data->size() + batch_alignment - 1) / batch_alignment * batch_alignment;
+    data->resize(offset + entry->builder.GetSize());
+    std::memcpy(data->data() + offset, entry->builder.GetBufferPointer(), entry->builder.GetSize());
+    offsets.push_back(offset);
+    sizes.push_back(entry->builder.GetSize());
+  }
+
+  // The builder is reused for the descriptor, it returns to its pool once the descriptor is sent.
+  entry->builder.Clear();
+  buildBatchDescriptor(entry->builder, offsets, sizes);
+  outgoing.descriptor = BuilderPool::toMessage(entry);
+  outgoing.has_descriptor = true;
+  outgoing.data = toMessage(std::move(data));
+}
+
+bool GenericSocket::popBatchedMsg(simple_msgs::GenericMessage& msg) {
+  auto& batch = *received_batch_;
+  const auto& item = batch.items[batch.next++];
+
+  // The message aliases its part of the frame, which is kept alive as long as any message of the batch needs it.
+  void* data_ptr = static_cast<uint8_t*>(batch.data->data()) + item.first;
+  msg = std::shared_ptr<void*>{batch.data, &data_ptr};
+
+  if (batch.next == batch.items.size()) {
+    batch.data = nullptr;
+    batch.items.clear();
+    batch.next = 0;
+  }
+  return true;
+}
+
 bool GenericSocket::receiveMsg(simple_msgs::GenericMessage& msg, const std::string& custom_error) {
   // Early return if socket_ has not been created yet.
   if (socket_ == nullptr) { return false; }
 
   std::lock_guard<std::mutex> lock{mutex_};
+
+  // The messages of a batch received earlier come first.
+  if (received_batch_ != nullptr && received_batch_->next < received_batch_->items.size()) {
+    return popBatchedMsg(msg);
+  }
   zmq::recv_result_t success;
 
   // Local variables to check if data after the topic message is available and its size.
@@ -140,18 +865,30 @@ bool GenericSocket::receiveMsg(simple_msgs::GenericMessage& msg, const std::stri
   // This is the pointer handling the lifetime of the received data.
   std::shared_ptr<zmq::message_t> local_message(std::make_shared<zmq::message_t>());
 
+  // The payload of the message, if it is not contained in the message data.
+  std::shared_ptr<const void> payload{nullptr};
+  uint64_t payload_size{0};
+
   // Receive the first bytes, this should match the topic message and can be used to check if the right topic (the
   // right message type) has been received. i.e. the received topic message should match the one of the template
   // argument of this socket (stored in the topic_ member variable).
   try {
     if (!socket_->recv(*local_message.get())) { throw zmq::error_t(); };
 
+    // The welcome message of the Publisher is not a message to return.
+    if (local_message->size() == welcome_message.size() &&
+        std::memcmp(local_message->data(), welcome_message.data(), welcome_message.size()) == 0) {
+      welcomed_ = true;
+      return false;
+    }
+
     // Check if the received topic matches the right message topic.
     std::string received_message_type = static_cast<char*>(local_message->data());
     // if (std::strncmp(received_message_type.c_str(), topic_.c_str(), std::strlen(topic_.c_str())) != 0) {
     if (received_message_type.compare(0, topic_.size(), topic_, 0, topic_.size()) != 0) {
       std::cerr << custom_error << "Received message type " << received_message_type << " while expecting " << topic_
                 << "." << std::endl;
+      discardRemainingFrames();
       return false;
     }
 
@@ -169,6 +906,88 @@ bool GenericSocket::receiveMsg(simple_msgs::GenericMessage& msg, const std::stri
     // Check if any data has been received.
     if (success.value() == false || local_message->size() == 0) { throw zmq::error_t(); }
 
+    // A payload descriptor may follow the message data.
+    int payload_after_data{0};
+    auto payload_after_data_size{sizeof(payload_after_data)};
+    socket_->getsockopt(ZMQ_RCVMORE, &payload_after_data, &payload_after_data_size);
+
+    if (payload_after_data != 0) {
+      zmq::message_t descriptor_message;
+      if (!socket_->recv(descriptor_message)) { throw zmq::error_t(); }
+
+      // The message data of a batch holds several messages, they are returned one at a time from now on.
+      if (descriptor_message.size() >= 8 &&
+          flatbuffers::BufferHasIdentifier(descriptor_message.data(), simple_msgs::BatchFbsIdentifier())) {
+        discardRemainingFrames();
+
+        auto batch = simple_msgs::GetBatchFbs(descriptor_message.data());
+        auto offsets = batch->offsets();
+        auto sizes = batch->sizes();
+        if (offsets == nullptr || sizes == nullptr || offsets->size() == 0 || offsets->size() != sizes->size()) {
+          std::cerr << custom_error << "Received an empty or invalid batch of messages." << std::endl;
+          return false;
+        }
+
+        if (received_batch_ == nullptr) { received_batch_.reset(new ReceivedBatch{}); }
+        received_batch_->items.clear();
+        received_batch_->next = 0;
+        for (flatbuffers::uoffset_t i = 0; i < offsets->size(); ++i) {
+          auto offset = offsets->Get(i);
+          auto size = sizes->Get(i);
+          if (offset > local_message->size() || size > local_message->size() - offset) {
+            received_batch_->items.clear();
+            std::cerr << custom_error << "Received an empty or invalid batch of messages." << std::endl;
+            return false;
+          }
+          received_batch_->items.emplace_back(offset, size);
+        }
+        received_batch_->data = local_message;
+        return popBatchedMsg(msg);
+      }
+
+      if (descriptor_message.size() < 8 ||
+          !flatbuffers::BufferHasIdentifier(descriptor_message.data(), simple_msgs::PayloadFbsIdentifier())) {
+        discardRemainingFrames();
+        std::cerr << custom_error << "Received an unknown payload descriptor." << std::endl;
+        return false;
+      }
+      auto descriptor = simple_msgs::GetPayloadFbs(descriptor_message.data());
+      payload_size = descriptor->payload_size();
+
+      if (descriptor->location() == simple_msgs::PayloadLocation_zmq_frame) {
+        // The payload is the next frame, the message keeps it alive and aliases its data without copying it.
+        auto payload_message = std::make_shared<zmq::message_t>();
+        int payload_frame{0};
+        auto payload_frame_size{sizeof(payload_frame)};
+        socket_->getsockopt(ZMQ_RCVMORE, &payload_frame, &payload_frame_size);
+        if (payload_frame != 0 && socket_->recv(*payload_message)) {
+          payload = std::shared_ptr<const void>{payload_message, payload_message->data()};
+        }
+        discardRemainingFrames();
+
+        if (payload == nullptr || payload_message->size() != payload_size) {
+          std::cerr << custom_error << "The payload frame is missing or incomplete." << std::endl;
+          return false;
+        }
+      } else {
+        discardRemainingFrames();
+
+        if (shared_memory_reader_ == nullptr) { shared_memory_reader_.reset(new SharedMemoryReader{}); }
+        SharedMemoryDescriptor slot{};
+        slot.segment = descriptor->segment() != nullptr ? descriptor->segment()->str() : "";
+        slot.slot = descriptor->slot();
+        slot.generation = descriptor->generation();
+        slot.size = payload_size;
+        payload = shared_memory_reader_->acquire(slot);
+
+        if (payload == nullptr) {
+          ++lost_payloads_;
+          std::cerr << custom_error << "The shared memory payload is not available anymore." << std::endl;
+          return false;
+        }
+      }
+    }
+
   } catch (const zmq::error_t& error) {
     std::cerr << custom_error << "Failed to receive the message. ZMQ Error: " << error.what() << std::endl;
     return false;
@@ -184,13 +1003,87 @@ bool GenericSocket::receiveMsg(simple_msgs::GenericMessage& msg, const std::stri
   // the operator= of T, the ref counter is increased and local_message will stay alive until the object T needs the
   // data.
   msg = std::shared_ptr<void*>{local_message, &data_ptr};
+  if (payload != nullptr) { msg.setPayload(payload, payload_size); }
 
   return success.has_value();
 }
 
+bool GenericSocket::receiveRequestId(uint64_t& request_id, const std::string& custom_error) {
+  // Early return if socket_ has not been created yet.
+  if (socket_ == nullptr) { return false; }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  try {
+    zmq::message_t id_message;
+    zmq::message_t delimiter;
+    if (!socket_->recv(id_message)) { throw zmq::error_t(); }
+    if (id_message.size() != sizeof(request_id) || !id_message.more() || !socket_->recv(delimiter) ||
+        delimiter.size() != 0) {
+      std::cerr << custom_error << "Received a message without a valid request envelope." << std::endl;
+      discardRemainingFrames();
+      return false;
+    }
+    std::memcpy(&request_id, id_message.data(), sizeof(request_id));
+  } catch (const zmq::error_t& error) {
+    std::cerr << custom_error << "Failed to receive the message. ZMQ Error: " << error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool GenericSocket::receiveEnvelope(std::vector<std::string>& envelope, const std::string& custom_error) {
+  // Early return if socket_ has not been created yet.
+  if (socket_ == nullptr) { return false; }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  envelope.clear();
+  try {
+    // The envelope ends with the empty delimiter, the frames of the request follow it.
+    zmq::message_t frame;
+    if (!socket_->recv(frame)) { throw zmq::error_t(); }
+    while (frame.size() != 0 && frame.more()) {
+      envelope.emplace_back(static_cast<const char*>(frame.data()), frame.size());
+      if (!socket_->recv(frame)) { throw zmq::error_t(); }
+    }
+    if (frame.size() != 0 || !frame.more() || envelope.empty()) {
+      std::cerr << custom_error << "Received a message without a valid routing envelope." << std::endl;
+      discardRemainingFrames();
+      return false;
+    }
+  } catch (const zmq::error_t& error) {
+    std::cerr << custom_error << "Failed to receive the message. ZMQ Error: " << error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void GenericSocket::discardMsg() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (socket_ != nullptr) { discardRemainingFrames(); }
+}
+
 void GenericSocket::filter() {
   std::lock_guard<std::mutex> lock{mutex_};
   socket_->setsockopt(ZMQ_SUBSCRIBE, topic_.c_str(), topic_.size());
+  socket_->setsockopt(ZMQ_SUBSCRIBE, welcome_message.data(), welcome_message.size());
+}
+
+void GenericSocket::setRelaxed() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  const int enabled{1};
+  socket_->setsockopt(ZMQ_REQ_RELAXED, &enabled, sizeof(enabled));
+  socket_->setsockopt(ZMQ_REQ_CORRELATE, &enabled, sizeof(enabled));
+}
+
+void GenericSocket::setFailover(int heartbeat_interval, int send_timeout) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  const int immediate{1};
+  const int heartbeat_timeout{3 * heartbeat_interval};
+  socket_->setsockopt(ZMQ_IMMEDIATE, &immediate, sizeof(immediate));
+  socket_->setsockopt(ZMQ_HEARTBEAT_IVL, &heartbeat_interval, sizeof(heartbeat_interval));
+  socket_->setsockopt(ZMQ_HEARTBEAT_TIMEOUT, &heartbeat_timeout, sizeof(heartbeat_timeout));
+  socket_->setsockopt(ZMQ_HEARTBEAT_TTL, &heartbeat_timeout, sizeof(heartbeat_timeout));
+  socket_->setsockopt(ZMQ_SNDTIMEO, &send_timeout, sizeof(send_timeout));
 }
 
 void GenericSocket::setTimeout(int timeout) {
@@ -198,26 +1091,206 @@ void GenericSocket::setTimeout(int timeout) {
   socket_->setsockopt(ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
 }
 
+void GenericSocket::setSendTimeout(int timeout) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  socket_->setsockopt(ZMQ_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
 void GenericSocket::setLinger(int linger) {
   std::lock_guard<std::mutex> lock{mutex_};
   socket_->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
 }
 
+void GenericSocket::setHighWaterMark(int send, int receive) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  socket_->setsockopt(ZMQ_SNDHWM, &send, sizeof(send));
+  socket_->setsockopt(ZMQ_RCVHWM, &receive, sizeof(receive));
+}
+
+void GenericSocket::setPayloadTransport(const PayloadTransport& transport, uint32_t num_slots) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  payload_transport_ = transport;
+  if (transport == PayloadTransport::shared_memory) {
+    shared_memory_pool_.reset(new SharedMemoryPool{num_slots});
+  } else {
+    shared_memory_pool_ = nullptr;
+  }
+}
+
+std::shared_ptr<void> GenericSocket::loanSharedMemory(uint64_t size) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return shared_memory_pool_ != nullptr ? shared_memory_pool_->loan(size) : nullptr;
+}
+
+void GenericSocket::setAsyncSend(bool enabled, size_t capacity, const std::string& custom_error) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (!enabled) {
+    async_sender_ = nullptr;
+  } else if (socket_ != nullptr) {
+    if (async_sender_ == nullptr) {
+      async_sender_.reset(new AsyncSender{*socket_, topic_, subscribers_, capacity, custom_error});
+    } else if (async_sender_->capacity() != capacity) {
+      replaceAsyncSender(capacity, async_sender_->maxBytes(), async_sender_->policy(), async_sender_->reportDrops(),
+                         custom_error);
+    }
+  }
+}
+
+void GenericSocket::setBackpressure(size_t max_messages, size_t max_bytes, const BackpressurePolicy& policy,
+                                    const std::string& custom_error) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (socket_ == nullptr) { return; }
+
+  // The socket waits for a slow peer instead of dropping, the send timeout lets the I/O thread apply the policy. The
+  // welcome message of a ZMQ_XPUB socket takes a slot of its queues.
+  const int high_water_mark{static_cast<int>(max_messages != 0 && subscribers_ != nullptr ? max_messages + 1
+                                                                                           : max_messages)};
+  const int no_drop{1};
+  const int send_timeout{10};
+  socket_->setsockopt(ZMQ_SNDHWM, &high_water_mark, sizeof(high_water_mark));
+  socket_->setsockopt(ZMQ_XPUB_NODROP, &no_drop, sizeof(no_drop));
+  socket_->setsockopt(ZMQ_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+  auto capacity = max_messages != 0 ? max_messages : std::numeric_limits<size_t>::max();
+  replaceAsyncSender(capacity, max_bytes, policy, false, custom_error);
+}
+
+void GenericSocket::replaceAsyncSender(size_t capacity, size_t max_bytes, const BackpressurePolicy& policy,
+                                       bool report_drops, const std::string& custom_error) {
+  std::chrono::microseconds coalescing_delay{0};
+  size_t coalescing_bytes{0};
+  if (async_sender_ != nullptr) {
+    coalescing_delay = async_sender_->coalescingDelay();
+    coalescing_bytes = async_sender_->coalescingBytes();
+    // The queued messages are sent before the queue is replaced, a single I/O thread owns the socket at a time.
+    async_sender_ = nullptr;
+  }
+  async_sender_.reset(
+      new AsyncSender{*socket_, topic_, subscribers_, capacity, custom_error, max_bytes, policy, report_drops});
+  if (coalescing_delay.count() != 0) { async_sender_->setCoalescing(coalescing_delay, coalescing_bytes); }
+}
+
+void GenericSocket::setCoalescing(std::chrono::microseconds max_delay, size_t max_bytes,
+                                  const std::string& custom_error) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (socket_ == nullptr) { return; }
+  if (async_sender_ == nullptr) {
+    async_sender_.reset(new AsyncSender{*socket_, topic_, subscribers_, 1000, custom_error});
+  }
+  async_sender_->setCoalescing(max_delay, max_bytes);
+}
+
+void GenericSocket::setMonitor(const SocketEventCallback& callback, const std::string& custom_error) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (socket_ == nullptr) { return; }
+  if (async_sender_ != nullptr) {
+    std::cerr << custom_error << "The monitor has to be set before enabling the asynchronous mode." << std::endl;
+    return;
+  }
+  std::lock_guard<std::mutex> monitor_lock{monitor_mutex_};
+  monitor_ = nullptr;  //! Only one monitor at a time.
+  monitor_.reset(new SocketMonitor{static_cast<void*>(*socket_), *ContextManager::instance(context_), callback});
+}
+
+uint64_t GenericSocket::eventCount(const SocketEvent& event) const {
+  std::lock_guard<std::mutex> lock{monitor_mutex_};
+  return monitor_ != nullptr ? monitor_->count(event) : 0;
+}
+
+uint64_t GenericSocket::droppedMessages() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return async_sender_ != nullptr ? async_sender_->dropped() : 0;
+}
+
+uint64_t GenericSocket::lostPayloads() const { return lost_payloads_.load(); }
+
+bool GenericSocket::hasPendingMsg() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (socket_ == nullptr) { return false; }
+  if (received_batch_ != nullptr && received_batch_->next < received_batch_->items.size()) { return true; }
+  int events{0};
+  auto events_size{sizeof(events)};
+  socket_->getsockopt(ZMQ_EVENTS, &events, &events_size);
+  return (events & ZMQ_POLLIN) != 0;
+}
+
+bool GenericSocket::isWelcomed() const { return welcomed_; }
+
+int GenericSocket::subscriberCount() const {
+  if (subscribers_ == nullptr) { return -1; }
+
+  // In asynchronous mode the socket belongs to the I/O thread, which counts the subscriptions itself.
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (async_sender_ == nullptr && socket_ != nullptr) { receiveSubscriptions(*socket_, topic_, *subscribers_); }
+  return subscribers_->load();
+}
+
+bool GenericSocket::hasBufferedMsg() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return received_batch_ != nullptr && received_batch_->next < received_batch_->items.size();
+}
+
 void GenericSocket::initSocket(const zmq_socket_type& type) {
   std::lock_guard<std::mutex> lock{mutex_};
   if (socket_ == nullptr) {
-    socket_ = std::unique_ptr<zmq::socket_t>(new zmq::socket_t(*ContextManager::instance(), static_cast<int>(type)));
+    socket_ = std::unique_ptr<zmq::socket_t>(
+        new zmq::socket_t(*ContextManager::instance(context_), static_cast<int>(type)));
+    builder_pool_ = std::make_shared<BuilderPool>();
+
+    // A ZMQ_XPUB socket passes every subscription and unsubscription up, so that its subscribers can be counted.
+    if (type == zmq_socket_type::xpub) {
+      const int verboser{1};
+      socket_->setsockopt(ZMQ_XPUB_VERBOSER, &verboser, sizeof(verboser));
+      socket_->setsockopt(ZMQ_XPUB_WELCOME_MSG, welcome_message.data(), welcome_message.size());
+
+      // The welcome message stays in the queue of each peer until ZMQ accounts for the next messages, an additional
+      // slot keeps the whole queue for the messages.
+      int high_water_mark{0};
+      auto high_water_mark_size{sizeof(high_water_mark)};
+      socket_->getsockopt(ZMQ_SNDHWM, &high_water_mark, &high_water_mark_size);
+      if (high_water_mark != 0) {
+        ++high_water_mark;
+        socket_->setsockopt(ZMQ_SNDHWM, &high_water_mark, sizeof(high_water_mark));
+      }
+      subscribers_ = std::make_shared<std::atomic<int>>(0);
+    }
+
+    // Mark the packets of the sockets of this context, e.g. to prioritize them in the network.
+    auto type_of_service = ContextManager::typeOfService(context_);
+    if (type_of_service != -1) { socket_->setsockopt(ZMQ_TOS, &type_of_service, sizeof(type_of_service)); }
   }
 }
 
 void GenericSocket::closeSocket() {
   std::lock_guard<std::mutex> lock{mutex_};
+  // Queued messages are sent before the socket is closed.
+  async_sender_ = nullptr;
+  {
+    std::lock_guard<std::mutex> monitor_lock{monitor_mutex_};
+    monitor_ = nullptr;  //! The socket is monitored until it is closed.
+  }
   if (socket_ != nullptr) {
     socket_->close();
     socket_ = nullptr;
   }
 }
 
+void GenericSocket::discardRemainingFrames() {
+  int more{0};
+  auto more_size{sizeof(more)};
+  socket_->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+  while (more != 0) {
+    zmq::message_t frame;
+    if (!socket_->recv(frame)) { break; }
+    socket_->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+  }
+}
+
 bool GenericSocket::isSocketValid() { return static_cast<bool>(socket_ != nullptr); }
 
+void* GenericSocket::nativeHandle() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return socket_ != nullptr ? static_cast<void*>(*socket_) : nullptr;
+}
+
 }  // namespace simple
@@ -0,0 +1,161 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+#include "simple/intra_process.hpp"
+
+namespace {
+//! The prefix of the addresses handled by an IntraProcessChannel.
+const std::string intra_process_scheme{"inproc+direct://"};
+
+//! All the channels existing in the process, indexed by their address.
+std::mutex registry_mutex{};
+std::map<std::string, std::weak_ptr<simple::IntraProcessChannel>> registry{};
+
+/**
+ * @brief Returns the channel with the given address, creating it if needed. registry_mutex has to be locked.
+ */
+std::shared_ptr<simple::IntraProcessChannel> getChannel(const std::string& address, const std::type_index& type) {
+  if (!simple::IntraProcessChannel::isIntraProcess(address) || address.size() == intra_process_scheme.size()) {
+    throw std::runtime_error("[SIMPLE Error] - Invalid intra-process address: " + address + ".");
+  }
+
+  auto channel = registry[address].lock();
+  if (channel == nullptr) {
+    // The channels that are not used anymore are forgotten, the addresses of a process may keep changing.
+    for (auto entry = registry.begin(); entry != registry.end();) {
+      entry = entry->second.expired() ? registry.erase(entry) : std::next(entry);
+    }
+    channel = std::make_shared<simple::IntraProcessChannel>(address, type);
+    registry[address] = channel;
+  }
+  return channel;
+}
+}  // namespace
+
+namespace simple {
+
+IntraProcessQueue::IntraProcessQueue(size_t capacity) : capacity_{capacity} {}
+
+bool IntraProcessQueue::push(const std::shared_ptr<const void>& msg) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (messages_.size() >= capacity_) {
+      ++dropped_;
+      if (policy_ != BackpressurePolicy::drop_oldest || messages_.empty()) { return false; }
+      messages_.pop_front();
+    }
+    messages_.push_back(msg);
+  }
+  condition_.notify_one();
+  return true;
+}
+
+bool IntraProcessQueue::pop(std::shared_ptr<const void>& msg, int timeout) {
+  std::unique_lock<std::mutex> lock{mutex_};
+  if (!condition_.wait_for(lock, std::chrono::milliseconds(timeout), [this] { return !messages_.empty(); })) {
+    return false;
+  }
+  msg = std::move(messages_.front());
+  messages_.pop_front();
+  return true;
+}
+
+bool IntraProcessQueue::empty() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return messages_.empty();
+}
+
+void IntraProcessQueue::setLimits(size_t capacity, const BackpressurePolicy& policy) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  capacity_ = capacity != 0 ? capacity : std::numeric_limits<size_t>::max();
+  policy_ = policy;
+}
+
+uint64_t IntraProcessQueue::dropped() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return dropped_;
+}
+
+bool IntraProcessChannel::isIntraProcess(const std::string& address) {
+  return address.compare(0, intra_process_scheme.size(), intra_process_scheme) == 0;
+}
+
+std::shared_ptr<IntraProcessChannel> IntraProcessChannel::bind(const std::string& address,
+                                                               const std::type_index& type) {
+  std::lock_guard<std::mutex> registry_lock{registry_mutex};
+  auto channel = getChannel(address, type);
+
+  std::lock_guard<std::mutex> lock{channel->mutex_};
+  if (channel->type_ != type) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot bind to the address: " + address +
+                             ". It is in use for a different message type.");
+  }
+  if (channel->bound_) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot bind to the address: " + address +
+                             ". Another Publisher is bound to it.");
+  }
+  channel->bound_ = true;
+  return channel;
+}
+
+std::shared_ptr<IntraProcessChannel> IntraProcessChannel::connect(const std::string& address,
+                                                                  const std::type_index& type) {
+  std::lock_guard<std::mutex> registry_lock{registry_mutex};
+  auto channel = getChannel(address, type);
+
+  std::lock_guard<std::mutex> lock{channel->mutex_};
+  if (channel->type_ != type) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot connect to the address: " + address +
+                             ". It is in use for a different message type.");
+  }
+  return channel;
+}
+
+IntraProcessChannel::IntraProcessChannel(const std::string& address, const std::type_index& type)
+  : address_{address}, type_{type} {}
+
+void IntraProcessChannel::unbind() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  bound_ = false;
+}
+
+void IntraProcessChannel::attach(const std::shared_ptr<IntraProcessQueue>& queue) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  queues_.push_back(queue);
+}
+
+void IntraProcessChannel::detach(const std::shared_ptr<IntraProcessQueue>& queue) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  queues_.erase(std::remove(queues_.begin(), queues_.end(), queue), queues_.end());
+}
+
+bool IntraProcessChannel::isBound() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return bound_;
+}
+
+size_t IntraProcessChannel::subscriberCount() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return queues_.size();
+}
+
+void IntraProcessChannel::deliver(const std::shared_ptr<const void>& msg) const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  for (const auto& queue : queues_) { queue->push(msg); }
+}
+
+}  // namespace simple
@@ -0,0 +1,98 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <zmq.hpp>
+
+#include "simple/poller.hpp"
+
+namespace simple {
+
+namespace {
+/**
+ * @brief Polls the given items, sockets and polled have room for one element per item.
+ */
+size_t pollItems(PollItem* items, size_t num_items, zmq::pollitem_t* sockets, PollItem** polled,
+                 std::chrono::microseconds timeout) {
+  using Clock = std::chrono::steady_clock;
+  const auto deadline = Clock::now() + timeout;
+
+  size_t num_sockets{0};
+  bool has_queues{false};
+  for (size_t i = 0; i < num_items; ++i) {
+    auto& item = items[i];
+    item.ready = false;
+    if (item.socket != nullptr) {
+      sockets[num_sockets] = {item.socket, 0, ZMQ_POLLIN, 0};
+      polled[num_sockets++] = &item;
+    } else if (item.queue != nullptr) {
+      has_queues = true;
+    }
+  }
+
+  while (true) {
+    size_t ready{0};
+    for (size_t i = 0; i < num_items; ++i) {
+      auto& item = items[i];
+      if (item.buffered || (item.queue != nullptr && !item.queue->empty())) {
+        item.ready = true;
+        ++ready;
+      }
+    }
+
+    // Wait for the sockets up to the deadline, rounded up to the next millisecond, or one slice if a queue is polled.
+    long poll_timeout{0};
+    if (ready == 0) {
+      if (timeout.count() < 0) {
+        poll_timeout = -1;
+      } else {
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+        poll_timeout = std::max<long>(0, (remaining + 999) / 1000);
+      }
+      if (has_queues && poll_timeout != 0) { poll_timeout = 1; }
+    }
+
+    if (num_sockets != 0) {
+      try {
+        zmq::poll(sockets, num_sockets, poll_timeout);
+      } catch (const zmq::error_t& error) {
+        std::cerr << "[SIMPLE Subscriber] - Failed to poll the sockets. ZMQ Error: " << error.what() << std::endl;
+        return ready;
+      }
+      for (size_t i = 0; i < num_sockets; ++i) {
+        if ((sockets[i].revents & ZMQ_POLLIN) != 0 && !polled[i]->ready) {
+          polled[i]->ready = true;
+          ++ready;
+        }
+      }
+    } else if (poll_timeout != 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (ready != 0 || (timeout.count() >= 0 && Clock::now() >= deadline)) { return ready; }
+  }
+}
+}  // namespace
+
+size_t poll(std::vector<PollItem>& items, std::chrono::microseconds timeout) {
+  std::vector<zmq::pollitem_t> sockets(items.size());
+  std::vector<PollItem*> polled(items.size());
+  return pollItems(items.data(), items.size(), sockets.data(), polled.data(), timeout);
+}
+
+size_t poll(PollItem& item, std::chrono::microseconds timeout) {
+  zmq::pollitem_t socket{};
+  PollItem* polled{nullptr};
+  return pollItems(&item, 1, &socket, &polled, timeout);
+}
+
+}  // namespace simple
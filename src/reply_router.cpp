@@ -0,0 +1,147 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+#include <iostream>
+#include <zmq.hpp>
+
+#include "simple/context_manager.hpp"
+#include "simple/reply_router.hpp"
+
+namespace simple {
+namespace {
+/**
+ * @brief Maximum number of requests handed over in a row, the queued replies are sent in between.
+ */
+constexpr int max_requests_per_poll{64};
+}  // namespace
+
+ReplyRouter::ReplyRouter(const std::string& address, const std::string& topic, int linger, const std::string& context)
+  : socket_{zmq_socket_type::router, topic, context} {
+  socket_.setLinger(linger);
+  socket_.bind(address);
+
+  // Every router gets its own wake up address, an inproc address is not released as soon as its socket is closed.
+  static std::atomic<uint64_t> router_counter{0};
+  auto wake_address = "inproc://simple-router-" + std::to_string(router_counter++);
+  wake_receiver_.reset(new zmq::socket_t{*ContextManager::instance(context), ZMQ_PAIR});
+  wake_sender_.reset(new zmq::socket_t{*ContextManager::instance(context), ZMQ_PAIR});
+  wake_receiver_->bind(wake_address);
+  wake_sender_->connect(wake_address);
+}
+
+ReplyRouter::~ReplyRouter() {
+  stop();
+  wake_sender_->close();
+  wake_receiver_->close();
+}
+
+void ReplyRouter::start(const RequestHandler& handler) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (thread_.joinable()) { return; }
+  handler_ = handler;
+  alive_ = true;
+  thread_ = std::thread(&ReplyRouter::run, this);
+}
+
+void ReplyRouter::stop() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    alive_ = false;
+    wake();
+  }
+  if (thread_.joinable()) { thread_.join(); }
+}
+
+bool ReplyRouter::receive(simple_msgs::GenericMessage& msg, uint64_t& request_id) {
+  std::vector<std::string> envelope{};
+  if (!socket_.receiveEnvelope(envelope, "[SIMPLE Server] - ")) { return false; }
+  if (!socket_.receiveMsg(msg, "[SIMPLE Server] - ")) { return false; }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  request_id = next_id_++;
+  pending_[request_id] = std::move(envelope);
+  return true;
+}
+
+bool ReplyRouter::reply(uint64_t request_id, std::unique_ptr<Reply> reply) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  auto pending = pending_.find(request_id);
+  if (!alive_ || pending == pending_.end()) { return false; }
+  replies_.push_back(QueuedReply{std::move(pending->second), std::move(reply)});
+  pending_.erase(pending);
+  wake();
+  return true;
+}
+
+void ReplyRouter::cancel(uint64_t request_id) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (pending_.erase(request_id) != 0) {
+    std::cerr << "[SIMPLE Server] - A request has been dropped without a reply." << std::endl;
+  }
+}
+
+void ReplyRouter::wake() {
+  zmq::message_t signal{};
+  wake_sender_->send(signal, zmq::send_flags::dontwait);
+}
+
+void ReplyRouter::run() {
+  zmq::pollitem_t items[] = {{static_cast<void*>(*wake_receiver_), 0, ZMQ_POLLIN, 0},
+                             {socket_.nativeHandle(), 0, ZMQ_POLLIN, 0}};
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (!alive_) { break; }
+    }
+    sendReplies();
+
+    // Sleep until a reply is queued or a request arrives.
+    try {
+      zmq::poll(items, 2, -1);
+    } catch (const zmq::error_t& error) {
+      if (error.num() == ETERM) { break; }
+      std::cerr << "[SIMPLE Server] - Failed to poll the socket. ZMQ Error: " << error.what() << std::endl;
+      continue;
+    }
+
+    if ((items[0].revents & ZMQ_POLLIN) != 0) {
+      zmq::message_t signal{};
+      while (wake_receiver_->recv(signal, zmq::recv_flags::dontwait)) {}
+    }
+
+    // Hand the requests that are available over before polling again, a steady stream of requests delays neither the
+    // replies nor stopping the router.
+    if ((items[1].revents & ZMQ_POLLIN) != 0) {
+      int handled{0};
+      do {
+        handler_(*this);
+      } while (++handled < max_requests_per_poll && zmq::poll(&items[1], 1, 0) > 0);
+    }
+  }
+
+  // The requests that are still waiting are not replied anymore.
+  std::lock_guard<std::mutex> lock{mutex_};
+  alive_ = false;
+  pending_.clear();
+  replies_.clear();
+}
+
+void ReplyRouter::sendReplies() {
+  std::deque<QueuedReply> replies{};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    replies.swap(replies_);
+  }
+  for (auto& queued : replies) { socket_.sendMsg(queued.reply->message(), queued.envelope, "[SIMPLE Server] - "); }
+}
+
+}  // namespace simple
@@ -0,0 +1,83 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <zmq.hpp>
+
+#include "simple/context_manager.hpp"
+#include "simple/request_broker.hpp"
+
+namespace simple {
+
+constexpr int RequestBroker::worker_high_water_mark;
+
+RequestBroker::RequestBroker(const std::string& address, int linger, const std::string& context_name) {
+  // Every broker gets its own inproc addresses, an inproc address is not released as soon as its socket is closed.
+  static std::atomic<uint64_t> broker_counter{0};
+  const auto id = std::to_string(broker_counter++);
+  worker_address_ = "inproc://simple-server-workers-" + id;
+  const auto control_address = "inproc://simple-server-control-" + id;
+
+  auto& context = *ContextManager::instance(context_name);
+  frontend_.reset(new zmq::socket_t{context, ZMQ_ROUTER});
+  backend_.reset(new zmq::socket_t{context, ZMQ_DEALER});
+  control_.reset(new zmq::socket_t{context, ZMQ_PAIR});
+  stopper_.reset(new zmq::socket_t{context, ZMQ_PAIR});
+
+  frontend_->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+  auto type_of_service = ContextManager::typeOfService(context_name);
+  if (type_of_service != -1) { frontend_->setsockopt(ZMQ_TOS, &type_of_service, sizeof(type_of_service)); }
+  backend_->setsockopt(ZMQ_SNDHWM, &worker_high_water_mark, sizeof(worker_high_water_mark));
+
+  try {
+    frontend_->bind(address);
+  } catch (const zmq::error_t& error) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot bind to the address/port: " + address +
+                             ". ZMQ Error: " + error.what());
+  }
+  backend_->bind(worker_address_);
+  control_->bind(control_address);
+  stopper_->connect(control_address);
+
+  // Query the bound endpoint from the ZMQ API.
+  char last_endpoint[1024];
+  size_t size = sizeof(last_endpoint);
+  frontend_->getsockopt(ZMQ_LAST_ENDPOINT, &last_endpoint, &size);
+  endpoint_ = last_endpoint;
+
+  thread_ = std::thread([this] {
+    // It returns once the TERMINATE command is received, or if the ZMQ context is terminated.
+    if (zmq_proxy_steerable(static_cast<void*>(*frontend_), static_cast<void*>(*backend_), nullptr,
+                            static_cast<void*>(*control_)) != 0 &&
+        zmq_errno() != ETERM) {
+      std::cerr << "[SIMPLE Server] - The request proxy stopped. ZMQ Error: " << zmq_strerror(zmq_errno())
+                << std::endl;
+    }
+  });
+}
+
+RequestBroker::~RequestBroker() {
+  try {
+    zmq::message_t terminate{"TERMINATE", 9};
+    stopper_->send(terminate, zmq::send_flags::none);
+  } catch (const zmq::error_t&) {
+    // The context is terminated, the proxy has stopped already.
+  }
+  thread_.join();
+  stopper_->close();
+  control_->close();
+  backend_->close();
+  frontend_->close();
+}
+
+}  // namespace simple
@@ -0,0 +1,172 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <zmq.hpp>
+
+#include "simple/context_manager.hpp"
+#include "simple/request_pipeline.hpp"
+
+namespace simple {
+namespace {
+/**
+ * @brief Maximum number of replies received in a row, the submitted requests and the timeouts are handled in between.
+ */
+constexpr int max_replies_per_poll{64};
+}  // namespace
+
+RequestPipeline::RequestPipeline(const std::string& address, const std::string& topic, int timeout, int linger,
+                                 const std::string& context)
+  : socket_{zmq_socket_type::dealer, topic, context}, timeout_{timeout} {
+  socket_.setLinger(linger);
+  // A request that cannot be queued, e.g. while the Server is down, fails instead of blocking the I/O thread.
+  socket_.setSendTimeout(0);
+  socket_.connect(address);
+
+  // Every pipeline gets its own wake up address, an inproc address is not released as soon as its socket is closed.
+  static std::atomic<uint64_t> pipeline_counter{0};
+  auto wake_address = "inproc://simple-pipeline-" + std::to_string(pipeline_counter++);
+  wake_receiver_.reset(new zmq::socket_t{*ContextManager::instance(context), ZMQ_PAIR});
+  wake_sender_.reset(new zmq::socket_t{*ContextManager::instance(context), ZMQ_PAIR});
+  wake_receiver_->bind(wake_address);
+  wake_sender_->connect(wake_address);
+
+  thread_ = std::thread(&RequestPipeline::run, this);
+}
+
+RequestPipeline::~RequestPipeline() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    alive_ = false;
+    wake();
+  }
+  thread_.join();
+  wake_sender_->close();
+  wake_receiver_->close();
+}
+
+void RequestPipeline::submit(std::unique_ptr<Request> request) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (alive_) {
+      submitted_.push_back(std::move(request));
+      wake();
+      return;
+    }
+  }
+  request->complete(false);  //! The I/O thread has stopped.
+}
+
+void RequestPipeline::wake() {
+  zmq::message_t signal{};
+  wake_sender_->send(signal, zmq::send_flags::dontwait);
+}
+
+void RequestPipeline::run() {
+  zmq::pollitem_t items[] = {{static_cast<void*>(*wake_receiver_), 0, ZMQ_POLLIN, 0},
+                             {socket_.nativeHandle(), 0, ZMQ_POLLIN, 0}};
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (!alive_) { break; }
+    }
+    sendSubmitted();
+    expire();
+
+    // Sleep until a request is submitted, a reply arrives or the oldest request times out.
+    long poll_timeout{-1};
+    if (!in_flight_.empty()) {
+      auto remaining = in_flight_.begin()->second.deadline - Clock::now();
+      poll_timeout = std::max<long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count() + 1);
+    }
+
+    try {
+      zmq::poll(items, 2, poll_timeout);
+    } catch (const zmq::error_t& error) {
+      if (error.num() == ETERM) { break; }
+      std::cerr << "[SIMPLE Client] - Failed to poll the socket. ZMQ Error: " << error.what() << std::endl;
+      continue;
+    }
+
+    if ((items[0].revents & ZMQ_POLLIN) != 0) {
+      zmq::message_t signal{};
+      while (wake_receiver_->recv(signal, zmq::recv_flags::dontwait)) {}
+    }
+
+    // Receive the replies that are available before polling again, a steady stream of replies does not delay the
+    // submitted requests and the timeouts.
+    if ((items[1].revents & ZMQ_POLLIN) != 0) {
+      int received{0};
+      do {
+        receiveReply();
+      } while (++received < max_replies_per_poll && zmq::poll(&items[1], 1, 0) > 0);
+    }
+  }
+
+  // The requests that are still waiting fail.
+  std::deque<std::unique_ptr<Request>> submitted{};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    alive_ = false;
+    submitted.swap(submitted_);
+  }
+  for (auto& request : submitted) { request->complete(false); }
+  for (auto& in_flight : in_flight_) { in_flight.second.request->complete(false); }
+  in_flight_.clear();
+}
+
+void RequestPipeline::sendSubmitted() {
+  std::deque<std::unique_ptr<Request>> submitted{};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    submitted.swap(submitted_);
+  }
+
+  for (auto& request : submitted) {
+    auto id = next_id_++;
+    if (!socket_.sendMsg(request->message(), id, "[SIMPLE Client] - ")) {
+      request->complete(false);
+      continue;
+    }
+    in_flight_[id] = InFlight{std::move(request), Clock::now() + timeout_};
+  }
+}
+
+void RequestPipeline::receiveReply() {
+  uint64_t id{0};
+  if (!socket_.receiveRequestId(id, "[SIMPLE Client] - ")) { return; }
+
+  // A reply arriving after its request timed out is dropped.
+  auto in_flight = in_flight_.find(id);
+  if (in_flight == in_flight_.end()) {
+    socket_.discardMsg();
+    return;
+  }
+
+  auto request = std::move(in_flight->second.request);
+  in_flight_.erase(in_flight);
+  request->complete(socket_.receiveMsg(request->reply(), "[SIMPLE Client] - "));
+}
+
+void RequestPipeline::expire() {
+  // Requests are sent in the order of their ids, with the same timeout: the oldest deadlines come first.
+  auto now = Clock::now();
+  while (!in_flight_.empty() && in_flight_.begin()->second.deadline <= now) {
+    auto request = std::move(in_flight_.begin()->second.request);
+    in_flight_.erase(in_flight_.begin());
+    std::cerr << "[SIMPLE Client] - No reply received. Aborting this request." << std::endl;
+    request->complete(false);
+  }
+}
+
+}  // namespace simple
@@ -0,0 +1,347 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "simple/shared_memory.hpp"
+
+namespace {
+//! The prefix of the segment names, readers refuse to map anything else.
+const std::string segment_prefix{"/simple-"};
+
+//! Marks a segment that has been fully initialized by its creator.
+constexpr uint32_t segment_magic{0x53494d50};
+
+//! Added to the readers count of a slot while it is being written. Readers arriving meanwhile see a negative count.
+constexpr int32_t writer_lock{-(1 << 30)};
+
+//! Maximum number of segments that a SharedMemoryReader keeps mapped.
+constexpr size_t max_cached_segments{8};
+
+/**
+ * @brief Layout of the control area, at the beginning of the segment. It is followed by the generation of each slot,
+ * i.e. a std::atomic<uint64_t> that is 0 while the slot is not valid. Only the creator of the segment writes to it.
+ */
+struct ControlBlock {
+  uint32_t magic;
+  uint32_t num_slots;
+  uint64_t slot_capacity;
+};
+
+#ifndef _WIN32
+size_t pageSize() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+
+size_t roundToPages(size_t size) {
+  const auto page = pageSize();
+  return ((size + page - 1) / page) * page;
+}
+
+size_t controlSize(uint32_t num_slots) {
+  return roundToPages(sizeof(ControlBlock) + num_slots * sizeof(std::atomic<uint64_t>));
+}
+
+/**
+ * @brief Size of the readers area, which follows the control area. It holds the number of readers of each slot, i.e.
+ * a std::atomic<int32_t> that is negative while the slot is written.
+ */
+size_t readersSize(uint32_t num_slots) { return roundToPages(num_slots * sizeof(std::atomic<int32_t>)); }
+#endif
+}  // namespace
+
+namespace simple {
+
+/**
+ * @class SharedMemorySegment.
+ * @brief RAII wrapper of a POSIX shared memory segment holding a fixed number of equally sized slots.
+ *
+ * The control area and the slots are mapped read-only on the readers side, only the readers area is mapped read-write
+ * since readers have to count themselves in. The segment is unlinked when its creator releases it, processes that
+ * mapped it already keep it alive until they release it too.
+ */
+class SharedMemorySegment {
+public:
+  /**
+   * @brief Creates a new segment with a unique name.
+   */
+  static std::shared_ptr<SharedMemorySegment> create(uint32_t num_slots, uint64_t slot_capacity);
+
+  /**
+   * @brief Maps an existing segment. Returns nullptr if it does not exist anymore.
+   */
+  static std::shared_ptr<SharedMemorySegment> open(const std::string& name);
+
+  ~SharedMemorySegment();
+
+  SharedMemorySegment(const SharedMemorySegment&) = delete;
+  SharedMemorySegment& operator=(const SharedMemorySegment&) = delete;
+
+  inline const std::string& name() const { return name_; }
+  inline uint32_t numSlots() const { return num_slots_; }
+  inline uint64_t slotCapacity() const { return slot_capacity_; }
+
+  inline std::atomic<uint64_t>& generation(uint32_t slot) {
+    return reinterpret_cast<std::atomic<uint64_t>*>(control_ + 1)[slot];
+  }
+  inline std::atomic<int32_t>& readers(uint32_t slot) { return readers_[slot]; }
+  inline uint8_t* data(uint32_t slot) { return data_ + slot * slotCapacity(); }
+
+private:
+  SharedMemorySegment() = default;
+
+  std::string name_{""};                    //! Name of the segment.
+  bool owner_{false};                       //! Whether the segment has been created by this instance.
+  uint32_t num_slots_{0};                   //! Number of slots, as read when the segment has been mapped.
+  uint64_t slot_capacity_{0};               //! Size of each slot, as read when the segment has been mapped.
+  ControlBlock* control_{nullptr};          //! The mapped control area.
+  size_t control_size_{0};                  //! Size of the control area.
+  std::atomic<int32_t>* readers_{nullptr};  //! The mapped readers area.
+  size_t readers_size_{0};                  //! Size of the readers area.
+  uint8_t* data_{nullptr};                  //! The mapped slots.
+  size_t data_size_{0};                     //! Size of all the slots.
+};
+
+#ifndef _WIN32
+std::shared_ptr<SharedMemorySegment> SharedMemorySegment::create(uint32_t num_slots, uint64_t slot_capacity) {
+  static std::atomic<uint32_t> counter{0};
+  std::shared_ptr<SharedMemorySegment> segment{new SharedMemorySegment{}};
+  segment->name_ = segment_prefix + std::to_string(getpid()) + "-" + std::to_string(counter++);
+
+  auto fd = shm_open(segment->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot create the shared memory segment " + segment->name_ + ": " +
+                             std::strerror(errno));
+  }
+  segment->owner_ = true;
+  segment->num_slots_ = num_slots;
+  segment->slot_capacity_ = slot_capacity;
+
+  segment->control_size_ = controlSize(num_slots);
+  segment->readers_size_ = readersSize(num_slots);
+  segment->data_size_ = static_cast<size_t>(num_slots * slot_capacity);
+  auto control = MAP_FAILED;
+  auto readers = MAP_FAILED;
+  auto data = MAP_FAILED;
+  const auto data_offset = segment->control_size_ + segment->readers_size_;
+  if (ftruncate(fd, static_cast<off_t>(data_offset + segment->data_size_)) == 0) {
+    control = mmap(nullptr, segment->control_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    readers = mmap(nullptr, segment->readers_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                   static_cast<off_t>(segment->control_size_));
+    data = mmap(nullptr, segment->data_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(data_offset));
+  }
+  close(fd);
+  // The destructor takes care of whatever has been mapped and of unlinking the segment.
+  if (control != MAP_FAILED) { segment->control_ = static_cast<ControlBlock*>(control); }
+  if (readers != MAP_FAILED) { segment->readers_ = static_cast<std::atomic<int32_t>*>(readers); }
+  if (data != MAP_FAILED) { segment->data_ = static_cast<uint8_t*>(data); }
+  if (segment->control_ == nullptr || segment->readers_ == nullptr || segment->data_ == nullptr) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot map the shared memory segment " + segment->name_ + ".");
+  }
+
+  segment->control_->num_slots = num_slots;
+  segment->control_->slot_capacity = slot_capacity;
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    new (&segment->generation(i)) std::atomic<uint64_t>{0};
+    new (&segment->readers(i)) std::atomic<int32_t>{0};
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  segment->control_->magic = segment_magic;
+  return segment;
+}
+
+std::shared_ptr<SharedMemorySegment> SharedMemorySegment::open(const std::string& name) {
+  if (name.compare(0, segment_prefix.size(), segment_prefix) != 0 || name.find('/', 1) != std::string::npos) {
+    return nullptr;
+  }
+
+  auto fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1) { return nullptr; }
+
+  std::shared_ptr<SharedMemorySegment> segment{new SharedMemorySegment{}};
+  segment->name_ = name;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < pageSize()) {
+    close(fd);
+    return nullptr;
+  }
+
+  // Map the first page to learn the layout, then map the whole control area and the slots.
+  auto first_page = mmap(nullptr, pageSize(), PROT_READ, MAP_SHARED, fd, 0);
+  if (first_page == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  const auto layout = *static_cast<const ControlBlock*>(first_page);
+  munmap(first_page, pageSize());
+
+  segment->num_slots_ = layout.num_slots;
+  segment->slot_capacity_ = layout.slot_capacity;
+  segment->control_size_ = controlSize(layout.num_slots);
+  segment->readers_size_ = readersSize(layout.num_slots);
+  segment->data_size_ = static_cast<size_t>(layout.num_slots * layout.slot_capacity);
+  const auto data_offset = segment->control_size_ + segment->readers_size_;
+  if (layout.magic != segment_magic || static_cast<size_t>(info.st_size) != data_offset + segment->data_size_) {
+    close(fd);
+    return nullptr;
+  }
+
+  // Only the readers area is writable, a reader cannot corrupt the generations nor the payloads.
+  auto control = mmap(nullptr, segment->control_size_, PROT_READ, MAP_SHARED, fd, 0);
+  auto readers = mmap(nullptr, segment->readers_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                      static_cast<off_t>(segment->control_size_));
+  auto data = mmap(nullptr, segment->data_size_, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(data_offset));
+  close(fd);
+  if (control != MAP_FAILED) { segment->control_ = static_cast<ControlBlock*>(control); }
+  if (readers != MAP_FAILED) { segment->readers_ = static_cast<std::atomic<int32_t>*>(readers); }
+  if (data != MAP_FAILED) { segment->data_ = static_cast<uint8_t*>(data); }
+  if (segment->control_ == nullptr || segment->readers_ == nullptr || segment->data_ == nullptr) { return nullptr; }
+  return segment;
+}
+
+SharedMemorySegment::~SharedMemorySegment() {
+  if (control_ != nullptr) { munmap(control_, control_size_); }
+  if (readers_ != nullptr) { munmap(readers_, readers_size_); }
+  if (data_ != nullptr) { munmap(data_, data_size_); }
+  if (owner_) { shm_unlink(name_.c_str()); }
+}
+#else
+std::shared_ptr<SharedMemorySegment> SharedMemorySegment::create(uint32_t, uint64_t) {
+  throw std::runtime_error("[SIMPLE Error] - Shared memory payloads are not supported on this platform.");
+}
+
+std::shared_ptr<SharedMemorySegment> SharedMemorySegment::open(const std::string&) { return nullptr; }
+
+SharedMemorySegment::~SharedMemorySegment() {}
+#endif
+
+SharedMemoryPool::SharedMemoryPool(uint32_t num_slots)
+  : num_slots_{std::max<uint32_t>(num_slots, 1)}, loans_(num_slots_) {
+#ifdef _WIN32
+  throw std::runtime_error("[SIMPLE Error] - Shared memory payloads are not supported on this platform.");
+#endif
+}
+
+SharedMemoryPool::~SharedMemoryPool() = default;
+
+std::shared_ptr<void> SharedMemoryPool::loan(uint64_t size) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  reserve(size);
+
+  uint32_t slot{0};
+  if (!lockFreeSlot(slot)) { return nullptr; }
+  // Invalidate the slot for late readers, it is filled without holding the lock.
+  segment_->generation(slot).store(0, std::memory_order_relaxed);
+  segment_->readers(slot).fetch_sub(writer_lock, std::memory_order_release);
+
+  // The loaned buffer keeps the segment alive, even if the pool has to replace it meanwhile.
+  auto segment = segment_;
+  std::shared_ptr<void> buffer{segment->data(slot), [segment](void*) {}};
+  loans_[slot] = buffer;
+  next_slot_ = (slot + 1) % num_slots_;
+  return buffer;
+}
+
+bool SharedMemoryPool::write(const simple_msgs::Payload& payload, SharedMemoryDescriptor& descriptor) {
+  std::lock_guard<std::mutex> lock{mutex_};
+
+  // A loaned slot has been filled already, it only needs a new generation.
+  if (segment_ != nullptr) {
+    for (uint32_t slot = 0; slot < num_slots_; ++slot) {
+      auto loaned = loans_[slot].lock();
+      if (loaned != nullptr && loaned.get() == payload.data.get() && payload.size <= segment_->slotCapacity()) {
+        segment_->generation(slot).store(++generation_, std::memory_order_release);
+        descriptor = SharedMemoryDescriptor{segment_->name(), slot, generation_, payload.size};
+        return true;
+      }
+    }
+  }
+
+  reserve(payload.size);
+  uint32_t slot{0};
+  if (!lockFreeSlot(slot)) { return false; }
+
+  std::memcpy(segment_->data(slot), payload.data.get(), static_cast<size_t>(payload.size));
+  segment_->generation(slot).store(++generation_, std::memory_order_relaxed);
+  segment_->readers(slot).fetch_sub(writer_lock, std::memory_order_release);
+
+  descriptor = SharedMemoryDescriptor{segment_->name(), slot, generation_, payload.size};
+  next_slot_ = (slot + 1) % num_slots_;
+  return true;
+}
+
+void SharedMemoryPool::reserve(uint64_t size) {
+  if (segment_ != nullptr && size <= segment_->slotCapacity()) { return; }
+  // Slots grow to the next 4 KiB, readers still holding the previous segment keep it mapped until they are done.
+  const uint64_t capacity = std::max<uint64_t>(((size + 4095) / 4096) * 4096, 4096);
+  segment_ = SharedMemorySegment::create(num_slots_, capacity);
+  loans_.assign(num_slots_, std::weak_ptr<void>{});
+  next_slot_ = 0;
+}
+
+bool SharedMemoryPool::lockFreeSlot(uint32_t& slot) {
+  for (uint32_t i = 0; i < num_slots_; ++i) {
+    const auto candidate = (next_slot_ + i) % num_slots_;
+    if (!loans_[candidate].expired()) { continue; }
+    int32_t expected{0};
+    if (segment_->readers(candidate).compare_exchange_strong(expected, writer_lock, std::memory_order_acquire)) {
+      slot = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+SharedMemoryReader::~SharedMemoryReader() = default;
+
+std::shared_ptr<const void> SharedMemoryReader::acquire(const SharedMemoryDescriptor& descriptor) {
+  std::shared_ptr<SharedMemorySegment> segment{nullptr};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto cached = std::find_if(segments_.begin(), segments_.end(),
+                               [&descriptor](const std::shared_ptr<SharedMemorySegment>& s) {
+                                 return s->name() == descriptor.segment;
+                               });
+    if (cached != segments_.end()) {
+      segment = *cached;
+    } else {
+      segment = SharedMemorySegment::open(descriptor.segment);
+      if (segment == nullptr) { return nullptr; }
+      segments_.push_front(segment);
+      if (segments_.size() > max_cached_segments) { segments_.pop_back(); }
+    }
+  }
+
+  if (descriptor.slot >= segment->numSlots() || descriptor.size > segment->slotCapacity()) { return nullptr; }
+
+  auto& readers = segment->readers(descriptor.slot);
+  if (readers.fetch_add(1, std::memory_order_acquire) < 0 ||
+      segment->generation(descriptor.slot).load(std::memory_order_acquire) != descriptor.generation) {
+    readers.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+  }
+
+  const auto slot = descriptor.slot;
+  return std::shared_ptr<const void>{segment->data(slot), [segment, slot](const void*) {
+                                       segment->readers(slot).fetch_sub(1, std::memory_order_release);
+                                     }};
+}
+
+}  // namespace simple
@@ -0,0 +1,116 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <zmq.hpp>
+
+#include "simple/socket_monitor.hpp"
+
+namespace simple {
+namespace {
+/**
+ * @brief The ZMQ events reported by a SocketMonitor. The end of the monitoring is needed to stop its thread.
+ */
+constexpr int monitored_events = ZMQ_EVENT_CONNECTED | ZMQ_EVENT_ACCEPTED | ZMQ_EVENT_DISCONNECTED |
+                                 ZMQ_EVENT_CONNECT_RETRIED | ZMQ_EVENT_HANDSHAKE_FAILED_NO_DETAIL |
+                                 ZMQ_EVENT_HANDSHAKE_FAILED_PROTOCOL | ZMQ_EVENT_HANDSHAKE_FAILED_AUTH |
+                                 ZMQ_EVENT_MONITOR_STOPPED;
+
+/**
+ * @brief Every monitor publishes its events on its own inproc address.
+ */
+std::atomic<uint64_t> monitor_id{0};
+
+/**
+ * @brief Maps a ZMQ event to a SocketEvent, returns SocketEvent::count for the events that are not reported.
+ */
+SocketEvent toSocketEvent(uint16_t event) {
+  switch (event) {
+    case ZMQ_EVENT_CONNECTED:
+      return SocketEvent::connected;
+    case ZMQ_EVENT_ACCEPTED:
+      return SocketEvent::accepted;
+    case ZMQ_EVENT_DISCONNECTED:
+      return SocketEvent::disconnected;
+    case ZMQ_EVENT_CONNECT_RETRIED:
+      return SocketEvent::connect_retried;
+    case ZMQ_EVENT_HANDSHAKE_FAILED_NO_DETAIL:
+    case ZMQ_EVENT_HANDSHAKE_FAILED_PROTOCOL:
+    case ZMQ_EVENT_HANDSHAKE_FAILED_AUTH:
+      return SocketEvent::handshake_failed;
+    default:
+      return SocketEvent::count;
+  }
+}
+}  // namespace
+
+SocketMonitor::SocketMonitor(void* socket, zmq::context_t& context, const SocketEventCallback& callback)
+  : socket_{socket}, callback_{callback} {
+  for (auto& count : counts_) { count = 0; }
+
+  auto address = "inproc://simple-monitor-" + std::to_string(monitor_id++);
+  if (zmq_socket_monitor(socket_, address.c_str(), monitored_events) != 0) {
+    throw std::runtime_error("[SIMPLE Error] - Cannot monitor the socket. ZMQ Error: " +
+                             std::string{zmq_strerror(zmq_errno())});
+  }
+
+  // The events are received with a timeout, to notice that the monitor has been stopped.
+  events_socket_ = std::unique_ptr<zmq::socket_t>(new zmq::socket_t(context, ZMQ_PAIR));
+  const int timeout{100};
+  const int linger{0};
+  events_socket_->setsockopt(ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
+  events_socket_->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+  events_socket_->connect(address);
+
+  thread_ = std::thread(&SocketMonitor::run, this);
+}
+
+SocketMonitor::~SocketMonitor() {
+  zmq_socket_monitor(socket_, nullptr, 0);
+  alive_ = false;
+  if (thread_.joinable()) { thread_.join(); }
+  events_socket_->close();
+}
+
+uint64_t SocketMonitor::count(const SocketEvent& event) const {
+  return event < SocketEvent::count ? counts_[static_cast<size_t>(event)].load() : 0;
+}
+
+void SocketMonitor::run() {
+  while (alive_) {
+    // An event is made of two frames: the event number and its value, then the endpoint it refers to.
+    zmq::message_t event_message{};
+    zmq::message_t endpoint_message{};
+    try {
+      if (!events_socket_->recv(event_message)) { continue; }
+      if (!events_socket_->recv(endpoint_message)) { continue; }
+    } catch (const zmq::error_t& error) {
+      if (error.num() != ETERM) {
+        std::cerr << "[SIMPLE Error] - Failed to receive a socket event. ZMQ Error: " << error.what() << std::endl;
+      }
+      return;
+    }
+    if (event_message.size() < sizeof(uint16_t)) { continue; }
+
+    uint16_t zmq_event{0};
+    std::memcpy(&zmq_event, event_message.data(), sizeof(zmq_event));
+    if (zmq_event == ZMQ_EVENT_MONITOR_STOPPED) { return; }
+
+    auto event = toSocketEvent(zmq_event);
+    if (event == SocketEvent::count) { continue; }
+    ++counts_[static_cast<size_t>(event)];
+    if (callback_) {
+      callback_(event, std::string{static_cast<const char*>(endpoint_message.data()), endpoint_message.size()});
+    }
+  }
+}
+}  // Namespace simple.
@@ -0,0 +1,183 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "simple/thread_pool.hpp"
+
+namespace {
+// The pool and the queue index of the calling thread, if it belongs to a pool.
+thread_local const simple::ThreadPool* current_pool{nullptr};
+thread_local size_t current_queue{0};
+
+// The dispatcher whose callback is running on the calling thread, if any.
+thread_local const simple::CallbackDispatcher* current_dispatcher{nullptr};
+}  // namespace
+
+namespace simple {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  num_threads = std::max<size_t>(num_threads, 1);
+  for (size_t i = 0; i < num_threads; ++i) { queues_.emplace_back(new Queue{}); }
+  for (size_t i = 0; i < num_threads; ++i) { threads_.emplace_back(&ThreadPool::run, this, i); }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    alive_ = false;
+  }
+  wake_condition_.notify_all();
+  for (auto& thread : threads_) { thread.join(); }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+  // A task posted from a thread of the pool is likely to use the same data, it is kept on the same thread.
+  auto index = current_pool == this ? current_queue : next_queue_++ % queues_.size();
+
+  // The task is counted before it is queued, an idle thread that sees it counted looks for it until it is found.
+  ++queued_;
+  {
+    std::lock_guard<std::mutex> lock{queues_[index]->mutex};
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  { std::lock_guard<std::mutex> lock{sleep_mutex_}; }
+  wake_condition_.notify_one();
+}
+
+bool ThreadPool::take(size_t index, std::function<void()>& task) {
+  // The own queue is consumed in FIFO order.
+  {
+    std::lock_guard<std::mutex> lock{queues_[index]->mutex};
+    auto& tasks = queues_[index]->tasks;
+    if (!tasks.empty()) {
+      task = std::move(tasks.front());
+      tasks.pop_front();
+      return true;
+    }
+  }
+
+  // Steal the most recently queued task of another thread, the oldest ones are about to be run by their own thread.
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    auto& queue = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::run(size_t index) {
+  current_pool = this;
+  current_queue = index;
+
+  std::function<void()> task{};
+  while (true) {
+    if (take(index, task)) {
+      --queued_;
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    // Sleep until a task is posted. The tasks still queued are run before the pool is stopped.
+    std::unique_lock<std::mutex> lock{sleep_mutex_};
+    wake_condition_.wait(lock, [this] { return queued_ > 0 || !alive_; });
+    if (!alive_ && queued_ == 0) { break; }
+  }
+}
+
+CallbackDispatcher::CallbackDispatcher(ThreadPool& pool, CallbackOrder order, size_t capacity)
+  : pool_(pool), order_{order}, capacity_{capacity} {}
+
+bool CallbackDispatcher::post(std::function<void()> callback) {
+  std::unique_lock<std::mutex> lock{mutex_};
+  if (pending_ >= capacity_) {
+    if (policy_ == BackpressurePolicy::block) {
+      done_condition_.wait(lock, [this] { return pending_ < capacity_; });
+    } else if (policy_ == BackpressurePolicy::drop_oldest && !fifo_.empty()) {
+      fifo_.pop_front();
+      --pending_;
+      ++dropped_;
+    } else {
+      ++dropped_;
+      return false;
+    }
+  }
+  ++pending_;
+
+  auto self = shared_from_this();
+  if (order_ == CallbackOrder::unordered) {
+    pool_.post([self, callback] { self->run(callback); });
+    return true;
+  }
+
+  // With FIFO ordering, a single task of this dispatcher is queued on the pool at a time.
+  fifo_.push_back(std::move(callback));
+  if (!scheduled_) {
+    scheduled_ = true;
+    pool_.post([self] { self->runNext(); });
+  }
+  return true;
+}
+
+void CallbackDispatcher::setLimits(size_t capacity, const BackpressurePolicy& policy) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  capacity_ = capacity != 0 ? capacity : std::numeric_limits<size_t>::max();
+  policy_ = policy;
+}
+
+uint64_t CallbackDispatcher::dropped() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return dropped_;
+}
+
+void CallbackDispatcher::wait() {
+  // The queued callbacks may need the calling thread, or wait for the calling callback to complete.
+  if (current_dispatcher == this) { return; }
+  std::unique_lock<std::mutex> lock{mutex_};
+  done_condition_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void CallbackDispatcher::runNext() {
+  std::function<void()> callback{};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    callback = std::move(fifo_.front());
+    fifo_.pop_front();
+  }
+  run(callback);
+
+  // Schedule the next callback as a new task, other dispatchers sharing the pool get their turn meanwhile.
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (fifo_.empty()) {
+    scheduled_ = false;
+  } else {
+    auto self = shared_from_this();
+    pool_.post([self] { self->runNext(); });
+  }
+}
+
+void CallbackDispatcher::run(const std::function<void()>& callback) {
+  auto previous_dispatcher = current_dispatcher;
+  current_dispatcher = this;
+  callback();
+  current_dispatcher = previous_dispatcher;
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  --pending_;
+  done_condition_.notify_all();
+}
+
+}  // namespace simple
@@ -11,6 +11,8 @@
 #ifndef SIMPLE_TESTS_UTILITIES_HPP
 #define SIMPLE_TESTS_UTILITIES_HPP
 
+#include <chrono>
+#include <functional>
 #include <thread>
 
 #include "random_generators.hpp"
@@ -62,6 +64,20 @@ size_t generatePort() {
 
 //! END - Random port generation.
 
+/**
+ * @brief Waits until the given condition holds, e.g. until the published messages have been received, instead of
+ * sleeping for a fixed time.
+ * @return false if the condition still does not hold after the given time.
+ */
+bool waitUntil(const std::function<bool()>& condition, std::chrono::milliseconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() >= deadline) { return false; }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
 //! Following are convininet objects for the pub/sub and client/server tests.
 //! Since those tests are performed for each message type, we need the same structures for each message.
 //! We keep them in the arrays down here and track which message type uses which elements of the array with the enum.
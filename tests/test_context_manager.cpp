@@ -12,8 +12,15 @@
 
 #include "catch.hpp"
 
+#include <stdexcept>
+#include <zmq.hpp>
+
+#include "simple/client.hpp"
+#include "simple/context_manager.hpp"
 #include "simple/publisher.hpp"
+#include "simple/server.hpp"
 #include "simple_msgs/bool.hpp"
+#include "simple_msgs/int.hpp"
 
 // Test: Context Manager lifetime using dynamic Linkage.
 
@@ -26,3 +33,48 @@ SCENARIO("SIMPLE ContextManager lifetime using dynamic linkage") {
   }
   simple::ContextManager::destroy();
 }
+
+SCENARIO("SIMPLE ContextManager configuration") {
+  simple::ContextManager::destroy();
+  GIVEN("Options for the ZMQ context.") {
+    simple::ContextOptions options{};
+    options.io_threads = 2;
+    options.max_sockets = 2048;
+    WHEN("The ContextManager is configured before the context is used.") {
+      simple::ContextManager::configure(options);
+      auto context = simple::ContextManager::instance();
+      THEN("The context is created with the given options.") {
+        REQUIRE(context->getctxopt(ZMQ_IO_THREADS) == 2);
+        REQUIRE(context->getctxopt(ZMQ_MAX_SOCKETS) == 2048);
+      }
+      THEN("The ContextManager cannot be configured anymore.") {
+        REQUIRE_THROWS_AS(simple::ContextManager::configure(options), std::runtime_error);
+      }
+    }
+  }
+  simple::ContextManager::destroy();
+  simple::ContextManager::configure(simple::ContextOptions{});
+}
+
+SCENARIO("SIMPLE named contexts") {
+  GIVEN("A Client and a Server in a named context.") {
+    simple::ContextOptions options{};
+    options.io_threads = 1;
+    options.type_of_service = 0xb8;
+    simple::ContextManager::configure("control", options);
+    auto callback = [](simple_msgs::Int& i) { i.set(i.get() + 1); };
+    simple::Server<simple_msgs::Int> server{"tcp://*:6667", callback, 1000, -1, 1, "control"};
+    simple::Client<simple_msgs::Int> client{"tcp://localhost:6667", 2000, -1, "control"};
+    WHEN("The client sends a request.") {
+      simple_msgs::Int i{41};
+      auto success = client.request(i);
+      THEN("The server replies through its own context.") {
+        REQUIRE(success);
+        REQUIRE(i.get() == 42);
+        REQUIRE(simple::ContextManager::instance("control") != simple::ContextManager::instance());
+        REQUIRE(simple::ContextManager::typeOfService("control") == 0xb8);
+      }
+    }
+  }
+  simple::ContextManager::destroy();
+}
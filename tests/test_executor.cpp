@@ -0,0 +1,123 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "simple/client.hpp"
+#include "simple/executor.hpp"
+#include "simple/publisher.hpp"
+#include "simple/server.hpp"
+#include "simple/subscriber.hpp"
+#include "test_utilities.hpp"
+
+using namespace simple_tests;
+
+// Test: Subscribers and Servers sharing the threads of an Executor.
+
+static constexpr size_t TEST_MESSAGES_TO_SEND = 10;
+static constexpr size_t NUM_SUBSCRIBERS = 8;
+static constexpr size_t WAIT_TIME_FOR_SUBSCRIBER = 2;  //! In seconds.
+static constexpr size_t TIME_BETWEEN_MESSAGES = 10;    //! In milliseconds.
+
+SCENARIO("An Executor without threads.") {
+  GIVEN("No threads.") {
+    WHEN("An Executor is created") {
+      THEN("An exception is thrown") { REQUIRE_THROWS(simple::Executor{0}); }
+    }
+  }
+}
+
+SCENARIO("Several Subscribers receiving messages on a single Executor thread.") {
+  GIVEN("Publishers and Subscribers sharing an Executor with one thread.") {
+    simple::Executor executor{1};
+    std::atomic<size_t> executor_received_messages{0};
+    std::vector<std::unique_ptr<simple::Publisher<simple_msgs::Point>>> publishers;
+    std::vector<std::unique_ptr<simple::Subscriber<simple_msgs::Point>>> subscribers;
+    for (size_t i = 0; i < NUM_SUBSCRIBERS; ++i) {
+      const auto port = generatePort();
+      publishers.emplace_back(new simple::Publisher<simple_msgs::Point>{"tcp://*:" + std::to_string(port)});
+      subscribers.emplace_back(new simple::Subscriber<simple_msgs::Point>{
+          "tcp://localhost:" + std::to_string(port),
+          [&executor_received_messages](const simple_msgs::Point&) { ++executor_received_messages; }, executor});
+    }
+    for (auto& publisher : publishers) {
+      REQUIRE(publisher->waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    }
+    WHEN("Every publisher publishes data") {
+      const auto message = createRandomPoint();
+      for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
+        for (auto& publisher : publishers) { publisher->publish(message); }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES * TEST_MESSAGES_TO_SEND));
+      THEN("Every message is received") {
+        REQUIRE(executor_received_messages.load() == NUM_SUBSCRIBERS * TEST_MESSAGES_TO_SEND);
+      }
+      AND_WHEN("Half of the subscribers are destroyed") {
+        subscribers.resize(NUM_SUBSCRIBERS / 2);
+        executor_received_messages = 0;
+        for (auto& publisher : publishers) { publisher->publish(message); }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES * TEST_MESSAGES_TO_SEND));
+        THEN("Only the remaining subscribers receive messages") {
+          REQUIRE(executor_received_messages.load() == NUM_SUBSCRIBERS / 2);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A Subscriber in a named context receiving messages on an Executor of the same context.") {
+  const auto port = generatePort();
+  GIVEN("A publisher, a subscriber and an Executor in the same named context.") {
+    const std::string context{"executor"};
+    simple::Executor executor{1, context};
+    std::atomic<size_t> received_messages{0};
+    simple::Publisher<simple_msgs::Point> pub{"tcp://*:" + std::to_string(port), context};
+    simple::Subscriber<simple_msgs::Point> sub{"tcp://localhost:" + std::to_string(port),
+                                               [&received_messages](const simple_msgs::Point&) { ++received_messages; },
+                                               executor, context};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("The publisher publishes data") {
+      for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) { pub.publish(createRandomPoint()); }
+      waitUntil([&] { return received_messages.load() == TEST_MESSAGES_TO_SEND; },
+                std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("Every message is received") { REQUIRE(received_messages.load() == TEST_MESSAGES_TO_SEND); }
+    }
+  }
+}
+
+SCENARIO("Client-Server to a Point message on an Executor.") {
+  const auto port = generatePort();
+  const auto server_address = "tcp://*:" + std::to_string(port);
+  const auto client_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A server running on an Executor.") {
+    simple::Executor executor{1};
+    simple::Client<simple_msgs::Point> client(client_address);
+    simple::Server<simple_msgs::Point> server(server_address, callbackFunctionPoint, executor);
+
+    WHEN("The client sends a request") {
+      auto p = createRandomPoint();
+      auto sentPoint = p;
+      client.request(p);
+      THEN("The data received is the equal to the sent point plus one") {
+        REQUIRE(p.getX() == Approx(sentPoint.getX() + 1.0));
+        REQUIRE(p.getY() == Approx(sentPoint.getY() + 1.0));
+        REQUIRE(p.getZ() == Approx(sentPoint.getZ() + 1.0));
+      }
+    }
+  }
+}
@@ -11,7 +11,10 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 #include "simple/publisher.hpp"
 #include "simple/subscriber.hpp"
@@ -32,7 +35,7 @@ SCENARIO("Publish and subscribe to a Bool message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Bool> pub{publisher_address};
     simple::Subscriber<simple_msgs::Bool> sub{subscriber_address, callbackFunctionConstBool};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomBool();
@@ -54,7 +57,7 @@ SCENARIO("Publish and subscribe to a Int message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Int> pub{publisher_address};
     simple::Subscriber<simple_msgs::Int> sub{subscriber_address, callbackFunctionConstInt};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomInt();
@@ -77,7 +80,7 @@ SCENARIO("Publish and subscribe to a Float message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Float> pub{publisher_address};
     simple::Subscriber<simple_msgs::Float> sub{subscriber_address, callbackFunctionConstFloat};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomFloat();
@@ -100,7 +103,7 @@ SCENARIO("Publish and subscribe to a Double message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Double> pub{publisher_address};
     simple::Subscriber<simple_msgs::Double> sub{subscriber_address, callbackFunctionConstDouble};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomDouble();
@@ -123,7 +126,7 @@ SCENARIO("Publish and subscribe to a String message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::String> pub{publisher_address};
     simple::Subscriber<simple_msgs::String> sub{subscriber_address, callbackFunctionConstString};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomString();
@@ -146,7 +149,7 @@ SCENARIO("Publish and subscribe to a Header message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Header> pub{publisher_address};
     simple::Subscriber<simple_msgs::Header> sub{subscriber_address, callbackFunctionConstHeader};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomHeader();
@@ -169,7 +172,7 @@ SCENARIO("Publish and subscribe to a Point message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Point> pub{publisher_address};
     simple::Subscriber<simple_msgs::Point> sub{subscriber_address, callbackFunctionConstPoint};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomPoint();
@@ -192,7 +195,7 @@ SCENARIO("Publish and subscribe to a Quaternion message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Quaternion> pub{publisher_address};
     simple::Subscriber<simple_msgs::Quaternion> sub{subscriber_address, callbackFunctionConstQuaternion};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomQuaternion();
@@ -215,7 +218,7 @@ SCENARIO("Publish and subscribe to a Pose message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Pose> pub{publisher_address};
     simple::Subscriber<simple_msgs::Pose> sub{subscriber_address, callbackFunctionConstPose};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomPose();
@@ -238,7 +241,7 @@ SCENARIO("Publish and subscribe to a Rotation Matrix message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::RotationMatrix> pub{publisher_address};
     simple::Subscriber<simple_msgs::RotationMatrix> sub{subscriber_address, callbackFunctionConstRotationMatrix};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomRotationMatrix();
@@ -261,7 +264,7 @@ SCENARIO("Publish and subscribe to a Transform message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::Transform> pub{publisher_address};
     simple::Subscriber<simple_msgs::Transform> sub{subscriber_address, callbackFunctionConstTransform};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomTransform();
@@ -284,7 +287,7 @@ SCENARIO("Publish and subscribe to a PointStamped message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::PointStamped> pub{publisher_address};
     simple::Subscriber<simple_msgs::PointStamped> sub{subscriber_address, callbackFunctionConstPointStamped};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomPointStamped();
@@ -307,7 +310,7 @@ SCENARIO("Publish and subscribe to a QuaternionStamped message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::QuaternionStamped> pub{publisher_address};
     simple::Subscriber<simple_msgs::QuaternionStamped> sub{subscriber_address, callbackFunctionConstQuaternionStamped};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomQuaternionStamped();
@@ -330,7 +333,7 @@ SCENARIO("Publish and subscribe to a PoseStamped message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::PoseStamped> pub{publisher_address};
     simple::Subscriber<simple_msgs::PoseStamped> sub{subscriber_address, callbackFunctionConstPoseStamped};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomPoseStamped();
@@ -354,7 +357,7 @@ SCENARIO("Publish and subscribe to a RotationMatrixStamped message.") {
     simple::Publisher<simple_msgs::RotationMatrixStamped> pub{publisher_address};
     simple::Subscriber<simple_msgs::RotationMatrixStamped> sub{subscriber_address,
                                                                callbackFunctionConstRotationMatrixStamped};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomRotationMatrixStamped();
@@ -379,7 +382,7 @@ SCENARIO("Publish and subscribe to a TransformStamped message.") {
   GIVEN("An instance of a subscriber.") {
     simple::Publisher<simple_msgs::TransformStamped> pub{publisher_address};
     simple::Subscriber<simple_msgs::TransformStamped> sub{subscriber_address, callbackFunctionConstTransformStamped};
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomTransformStamped();
@@ -404,8 +407,9 @@ SCENARIO("Publish a Pose and subscribe to a Point message") {
     size_t wrong_received_messages{0};  // Reset this variable;
     simple::Publisher<simple_msgs::Pose> pub{publisher_address};
     simple::Subscriber<simple_msgs::Point> sub{subscriber_address, callbackFunctionConstPoint};
-
-    std::this_thread::sleep_for(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    // The subscriber is not counted by a publisher of another topic, it is only welcomed by it.
+    REQUIRE_FALSE(pub.waitForSubscribers(1, std::chrono::milliseconds(100)));
+    REQUIRE(sub.waitForPublisher(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
     WHEN("A publisher publishes data") {
       for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
         auto message = createRandomPose();
@@ -416,3 +420,532 @@ SCENARIO("Publish a Pose and subscribe to a Point message") {
     REQUIRE(wrong_received_messages == 0);
   }
 }
+
+// Intra-process publishing and subscribing.
+SCENARIO("Publish and subscribe to a Point message within the same process.") {
+  const auto address = "inproc+direct://point_" + std::to_string(generatePort());
+  GIVEN("An instance of a subscriber on an intra-process channel.") {
+    size_t intra_received_messages{0};
+    simple_msgs::Point intra_received_point{};
+    simple::Subscriber<simple_msgs::Point> sub{address, [&](const simple_msgs::Point& p) {
+                                                 intra_received_point = p;
+                                                 ++intra_received_messages;
+                                               }};
+    simple::Publisher<simple_msgs::Point> pub{address};
+    WHEN("A publisher publishes data") {
+      for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
+        auto message = std::make_shared<const simple_msgs::Point>(createRandomPoint());
+        pub.publish(message);
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES));
+        THEN("The data received is the same as the one sent") { REQUIRE(*message == intra_received_point); }
+      }
+    }
+    REQUIRE(intra_received_messages == TEST_MESSAGES_TO_SEND);
+  }
+}
+
+SCENARIO("Bind and connect to an intra-process channel already in use.") {
+  const auto address = "inproc+direct://pose_" + std::to_string(generatePort());
+  GIVEN("A publisher bound to an intra-process channel.") {
+    simple::Publisher<simple_msgs::Pose> pub{address};
+    WHEN("Another publisher binds to the same channel") {
+      THEN("An exception is thrown") {
+        REQUIRE_THROWS_AS(simple::Publisher<simple_msgs::Pose>{address}, std::runtime_error);
+      }
+    }
+    WHEN("A subscriber of a different type connects to the channel") {
+      THEN("An exception is thrown") {
+        REQUIRE_THROWS_AS(simple::Subscriber<simple_msgs::Point>(address, callbackFunctionConstPoint),
+                          std::runtime_error);
+      }
+    }
+  }
+}
+
+// Shared memory payloads.
+SCENARIO("Publish and subscribe to an Image message through shared memory.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A publisher that transmits the image data through shared memory.") {
+    size_t shm_received_messages{0};
+    std::vector<float> shm_received_data{};
+    simple::Publisher<simple_msgs::Image<float>> pub{publisher_address};
+    pub.setPayloadTransport(simple::PayloadTransport::shared_memory);
+    simple::Subscriber<simple_msgs::Image<float>> sub{
+        subscriber_address, [&](const simple_msgs::Image<float>& image) {
+          shm_received_data.assign(image.getImageData(), image.getImageData() + image.getImageSize());
+          ++shm_received_messages;
+        }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("A publisher publishes an image") {
+      std::vector<float> image_data(640 * 480);
+      for (size_t i = 0; i < image_data.size(); ++i) { image_data[i] = static_cast<float>(i); }
+      simple_msgs::Image<float> message{};
+      message.setImageDimensions(640, 480, 1);
+      message.setImageData(image_data.data(), image_data.size());
+      for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
+        pub.publish(message);
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES));
+      }
+      THEN("The image data received is the same as the one sent") { REQUIRE(shm_received_data == image_data); }
+    }
+    REQUIRE(shm_received_messages == TEST_MESSAGES_TO_SEND);
+  }
+}
+
+SCENARIO("A Subscriber lagging behind the shared memory slots of a Publisher.") {
+  const auto port = generatePort();
+  constexpr int num_images = 10;
+  GIVEN("A publisher with two shared memory slots and a slow subscriber.") {
+    std::atomic<int> received_images{0};
+    simple::Publisher<simple_msgs::Image<float>> pub{"tcp://*:" + std::to_string(port)};
+    pub.setPayloadTransport(simple::PayloadTransport::shared_memory, 2);
+    simple::Subscriber<simple_msgs::Image<float>> sub{"tcp://localhost:" + std::to_string(port),
+                                                      [&](const simple_msgs::Image<float>&) {
+                                                        ++received_images;
+                                                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                                      }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("More images than slots are published at once") {
+      std::vector<float> image_data(64 * 48, 1.0f);
+      simple_msgs::Image<float> message{};
+      message.setImageDimensions(64, 48, 1);
+      message.setImageData(image_data.data(), image_data.size());
+      for (int i = 0; i < num_images; ++i) { pub.publish(message); }
+      waitUntil([&] { return received_images.load() + sub.droppedMessages() == num_images; },
+                std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("The images whose slot has been overwritten are counted as dropped") {
+        REQUIRE(sub.droppedMessages() > 0);
+        REQUIRE(received_images + sub.droppedMessages() == num_images);
+      }
+    }
+  }
+}
+
+SCENARIO("Publish and subscribe to an Image message with the image data in a separate frame.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A publisher that transmits the image data as a separate ZMQ frame.") {
+    size_t frame_received_messages{0};
+    std::vector<double> frame_received_data{};
+    simple::Publisher<simple_msgs::Image<double>> pub{publisher_address};
+    pub.setPayloadTransport(simple::PayloadTransport::zmq_frame);
+    simple::Subscriber<simple_msgs::Image<double>> sub{
+        subscriber_address, [&](const simple_msgs::Image<double>& image) {
+          frame_received_data.assign(image.getImageData(), image.getImageData() + image.getImageSize());
+          ++frame_received_messages;
+        }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("A publisher publishes an image that owns its data") {
+      auto image_data = std::make_shared<std::vector<double>>(64 * 64 * 64);
+      for (size_t i = 0; i < image_data->size(); ++i) { (*image_data)[i] = static_cast<double>(i); }
+      simple_msgs::Image<double> message{};
+      message.setImageDimensions(64, 64, 64);
+      message.setImageData(std::shared_ptr<const double>{image_data, image_data->data()}, image_data->size());
+      for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
+        pub.publish(message);
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES));
+      }
+      THEN("The image data received is the same as the one sent") { REQUIRE(frame_received_data == *image_data); }
+    }
+    REQUIRE(frame_received_messages == TEST_MESSAGES_TO_SEND);
+  }
+}
+
+// Asynchronous publishing from several threads.
+SCENARIO("Publish and subscribe to a Point message from several threads in asynchronous mode.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A publisher in asynchronous mode and a subscriber.") {
+    constexpr size_t num_threads = 4;
+    std::atomic<size_t> async_received_messages{0};
+    simple::Publisher<simple_msgs::Point> pub{publisher_address};
+    pub.setAsyncPublishing(true);
+    simple::Subscriber<simple_msgs::Point> sub{subscriber_address,
+                                               [&](const simple_msgs::Point&) { ++async_received_messages; }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("Several threads publish data at the same time") {
+      const auto message = createRandomPoint();
+      std::atomic<size_t> queued_messages{0};
+      std::vector<std::thread> threads;
+      for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&pub, &message, &queued_messages] {
+          for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
+            if (pub.publish(message)) { ++queued_messages; }
+          }
+        });
+      }
+      for (auto& thread : threads) { thread.join(); }
+      std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES * TEST_MESSAGES_TO_SEND));
+      THEN("All the messages are received") {
+        REQUIRE(queued_messages.load() == num_threads * TEST_MESSAGES_TO_SEND);
+        REQUIRE(async_received_messages.load() == num_threads * TEST_MESSAGES_TO_SEND);
+      }
+    }
+  }
+}
+
+// The serialization builders of a publisher are reused, messages of changing size must not be affected.
+SCENARIO("Publish and subscribe to String messages of different sizes.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("An instance of a subscriber.") {
+    std::vector<std::string> sized_received_strings{};
+    simple::Publisher<simple_msgs::String> pub{publisher_address};
+    simple::Subscriber<simple_msgs::String> sub{
+        subscriber_address, [&](const simple_msgs::String& string) { sized_received_strings.push_back(string.get()); }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("A publisher publishes longer and shorter strings") {
+      const std::vector<std::string> sent_strings{"a", std::string(5000, 'b'), "c", std::string(200, 'd'), ""};
+      for (const auto& string : sent_strings) {
+        pub.publish(simple_msgs::String{string});
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES));
+      }
+      THEN("The data received is the same as the one sent") { REQUIRE(sized_received_strings == sent_strings); }
+    }
+  }
+}
+
+SCENARIO("Publish and subscribe to Int messages with a slow subscriber and a backpressure policy.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr int num_messages = 200;
+  std::atomic<int> slow_received_messages{0};
+  std::atomic<int> last_received_int{-1};
+  auto slow_callback = [&](const simple_msgs::Int& i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ++slow_received_messages;
+    last_received_int = i.get();
+  };
+  GIVEN("A publisher that blocks when its queue is full.") {
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    pub.setBackpressure(10, 0, simple::BackpressurePolicy::block);
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, slow_callback};
+    sub.setBackpressure(10, simple::BackpressurePolicy::block);
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("The publisher publishes faster than the subscriber processes") {
+      for (int i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Int{i}); }
+      waitUntil([&] { return slow_received_messages.load() == num_messages; },
+                std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("No message is dropped") {
+        REQUIRE(pub.droppedMessages() == 0);
+        REQUIRE(slow_received_messages.load() == num_messages);
+      }
+    }
+  }
+  GIVEN("A subscriber that conflates its queue.") {
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, slow_callback};
+    sub.setBackpressure(10, simple::BackpressurePolicy::drop_oldest);
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("The publisher publishes faster than the subscriber processes") {
+      for (int i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Int{i}); }
+      waitUntil([&] { return last_received_int.load() == num_messages - 1; },
+                std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("The most recent message is received and every other one is counted as conflated or dropped") {
+        REQUIRE(last_received_int.load() == num_messages - 1);
+        REQUIRE(sub.conflatedMessages() > 0);
+        REQUIRE(slow_received_messages.load() + static_cast<int>(sub.conflatedMessages() + sub.droppedMessages()) ==
+                num_messages);
+      }
+    }
+  }
+}
+
+SCENARIO("Publish Int messages to a subscriber that only keeps the latest one.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr int num_messages = 1000;
+  GIVEN("A subscriber in latest mode.") {
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, simple::SubscriberMode::latest};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    THEN("No message is available before the first one is received") { REQUIRE(sub.getLatest() == nullptr); }
+    WHEN("A publisher publishes a burst of messages") {
+      for (int i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Int{i}); }
+      waitUntil(
+          [&] {
+            auto latest = sub.getLatest();
+            return latest != nullptr && latest->get() == num_messages - 1;
+          },
+          std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("Only the most recent message is kept") {
+        auto latest = sub.getLatest();
+        REQUIRE(latest != nullptr);
+        REQUIRE(latest->get() == num_messages - 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Poll the latest Point message received by a subscriber.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr int num_messages = 100;
+  GIVEN("A subscriber that buffers the latest message.") {
+    std::atomic<int> received_messages{0};
+    simple::Publisher<simple_msgs::Point> pub{publisher_address};
+    simple::Subscriber<simple_msgs::Point> sub{subscriber_address,
+                                               [&](const simple_msgs::Point&) { ++received_messages; }};
+    sub.bufferLatest();
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    simple_msgs::Point latest{};
+    THEN("No message is available before the first one is received") { REQUIRE(sub.tryGetLatest(latest) == false); }
+    WHEN("A publisher publishes several messages") {
+      for (int i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Point{1.0 * i, 2.0 * i, 3.0 * i}); }
+      waitUntil([&] { return received_messages.load() == num_messages; },
+                std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("The callback receives every message and the latest one can be polled once") {
+        REQUIRE(received_messages.load() == num_messages);
+        REQUIRE(sub.tryGetLatest(latest));
+        REQUIRE(latest == simple_msgs::Point{num_messages - 1.0, 2.0 * (num_messages - 1), 3.0 * (num_messages - 1)});
+        REQUIRE(sub.tryGetLatest(latest) == false);
+      }
+    }
+  }
+}
+
+SCENARIO("Receive Int messages on the calling thread from polling subscribers.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr int num_messages = 10;
+  GIVEN("A network subscriber and an intra-process subscriber in polling mode.") {
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    simple::Publisher<simple_msgs::Int> intra_pub{"inproc+direct://polling"};
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, simple::SubscriberMode::polling};
+    simple::Subscriber<simple_msgs::Int> intra_sub{"inproc+direct://polling", simple::SubscriberMode::polling};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    REQUIRE(intra_pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    simple_msgs::Int received{-1};
+    WHEN("Nothing is published") {
+      THEN("No message is received and polling times out") {
+        REQUIRE(sub.tryReceive(received) == false);
+        REQUIRE(sub.receive(received, std::chrono::milliseconds(10)) == false);
+        REQUIRE(simple::poll(std::chrono::milliseconds(10), sub, intra_sub) == 0);
+      }
+    }
+    WHEN("A publisher publishes several messages") {
+      for (int i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Int{i}); }
+      THEN("They are received in order") {
+        for (int i = 0; i < num_messages; ++i) {
+          REQUIRE(sub.receive(received, std::chrono::seconds(1)));
+          REQUIRE(received.get() == i);
+        }
+      }
+    }
+    WHEN("The intra-process publisher publishes a message") {
+      intra_pub.publish(simple_msgs::Int{42});
+      THEN("Only the intra-process subscriber is ready") {
+        REQUIRE(simple::poll(std::chrono::seconds(1), sub, intra_sub) == 1);
+        REQUIRE(sub.tryReceive(received) == false);
+        REQUIRE(intra_sub.tryReceive(received));
+        REQUIRE(received.get() == 42);
+      }
+    }
+  }
+}
+
+SCENARIO("Publish Point messages to a subscriber with a batch callback.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr size_t num_messages = 500;
+  constexpr size_t max_batch_size = 50;
+  GIVEN("A subscriber that receives the messages in batches.") {
+    std::vector<simple_msgs::Point> received_points{};
+    std::atomic<size_t> received_count{0};
+    size_t largest_batch{0};
+    simple::Publisher<simple_msgs::Point> pub{publisher_address};
+    simple::Subscriber<simple_msgs::Point> sub{subscriber_address,
+                                               [&](const simple::MessageBatch<simple_msgs::Point>& batch) {
+                                                 largest_batch = std::max(largest_batch, batch.size());
+                                                 received_points.insert(received_points.end(), batch.begin(),
+                                                                        batch.end());
+                                                 received_count += batch.size();
+                                               },
+                                               max_batch_size};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("A publisher publishes a burst of messages") {
+      for (size_t i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Point{1.0 * i, 0, 0}); }
+      waitUntil([&] { return received_count.load() == num_messages; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("Every message is received in order and no batch is larger than the maximum size") {
+        REQUIRE(received_points.size() == num_messages);
+        for (size_t i = 0; i < num_messages; ++i) { REQUIRE(received_points[i] == simple_msgs::Point{1.0 * i, 0, 0}); }
+        REQUIRE(largest_batch <= max_batch_size);
+      }
+    }
+    WHEN("The subscriber is asked to conflate its messages or to buffer the latest one") {
+      THEN("It refuses, every message is part of a batch") {
+        REQUIRE_THROWS_AS(sub.setBackpressure(10, simple::BackpressurePolicy::drop_oldest), std::runtime_error);
+        REQUIRE_THROWS_AS(sub.bufferLatest(), std::runtime_error);
+        REQUIRE_NOTHROW(sub.setBackpressure(10, simple::BackpressurePolicy::drop_newest));
+      }
+    }
+  }
+}
+
+SCENARIO("Publish a batch of Point messages and subscribe to them one by one.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr size_t num_messages = 1000;
+  GIVEN("An instance of a subscriber.") {
+    std::vector<simple_msgs::Point> received_points{};
+    std::atomic<size_t> received_count{0};
+    simple::Publisher<simple_msgs::Point> pub{publisher_address};
+    simple::Subscriber<simple_msgs::Point> sub{subscriber_address, [&](const simple_msgs::Point& point) {
+      received_points.push_back(point);
+      ++received_count;
+    }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("A publisher publishes a batch of messages") {
+      std::vector<simple_msgs::Point> sent_points{};
+      for (size_t i = 0; i < num_messages; ++i) { sent_points.emplace_back(1.0 * i, 2.0 * i, 3.0 * i); }
+      REQUIRE(pub.publishBatch(sent_points));
+      waitUntil([&] { return received_count.load() == num_messages; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("Every message of the batch is received in order") { REQUIRE(received_points == sent_points); }
+    }
+  }
+}
+
+SCENARIO("Publish Int messages through a publisher that coalesces them.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  constexpr size_t num_messages = 500;
+  GIVEN("A publisher coalescing the messages published within 200 microseconds.") {
+    std::vector<int> received_ints{};
+    std::atomic<size_t> received_count{0};
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    pub.setCoalescing(std::chrono::microseconds(200));
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, [&](const simple_msgs::Int& i) {
+      received_ints.push_back(i.get());
+      ++received_count;
+    }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("The publisher publishes a burst of messages") {
+      for (size_t i = 0; i < num_messages; ++i) { pub.publish(simple_msgs::Int{static_cast<int>(i)}); }
+      waitUntil([&] { return received_count.load() == num_messages; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("Every message is received in order") {
+        REQUIRE(received_ints.size() == num_messages);
+        for (size_t i = 0; i < num_messages; ++i) { REQUIRE(received_ints[i] == static_cast<int>(i)); }
+      }
+    }
+  }
+  GIVEN("A publisher coalescing the messages published within 300 milliseconds, then given a backpressure policy.") {
+    std::atomic<size_t> received_count{0};
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    pub.setCoalescing(std::chrono::milliseconds(300));
+    pub.setBackpressure(100, 0, simple::BackpressurePolicy::block);
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, [&](const simple_msgs::Int&) { ++received_count; }};
+    REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+    WHEN("The publisher publishes a single message") {
+      REQUIRE(pub.publish(simple_msgs::Int{1}));
+      THEN("It still waits for others to be coalesced with it before it is sent") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        REQUIRE(received_count.load() == 0);
+        REQUIRE(waitUntil([&] { return received_count.load() == 1; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+      }
+    }
+  }
+}
+
+SCENARIO("Count the subscribers of a publisher.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A publisher without subscribers.") {
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    REQUIRE(pub.subscriberCount() == 0);
+    REQUIRE_FALSE(pub.hasSubscribers());
+    REQUIRE(pub.publish(simple_msgs::Int{1}));
+    WHEN("A subscriber of its topic and a subscriber of another topic connect to it") {
+      std::vector<int> received_ints{};
+      std::atomic<size_t> received_count{0};
+      {
+        simple::Subscriber<simple_msgs::Int> sub{subscriber_address, [&](const simple_msgs::Int& i) {
+          received_ints.push_back(i.get());
+          ++received_count;
+        }};
+        simple::Subscriber<simple_msgs::Bool> other_sub{subscriber_address, [](const simple_msgs::Bool&) {}};
+        // Counting the subscribers lets the publisher welcome the other one, which is connected once welcomed.
+        REQUIRE(waitUntil(
+            [&] { return pub.subscriberCount() >= 1 && other_sub.waitForPublisher(std::chrono::milliseconds(0)); },
+            std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+        THEN("Only the subscriber of its topic is counted and receives the messages") {
+          REQUIRE(pub.subscriberCount() == 1);
+          REQUIRE(pub.hasSubscribers());
+          REQUIRE(pub.publish(simple_msgs::Int{2}));
+          waitUntil([&] { return received_count.load() == 1; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+          REQUIRE(received_ints == std::vector<int>{2});
+        }
+      }
+      waitUntil([&] { return pub.subscriberCount() == 0; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("No subscriber is counted once they are gone") { REQUIRE(pub.subscriberCount() == 0); }
+    }
+  }
+}
+
+SCENARIO("Wait for the subscribers of a publisher instead of sleeping.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A publisher and a subscriber that just connected to it.") {
+    std::vector<int> received_ints{};
+    std::atomic<size_t> received_count{0};
+    simple::Publisher<simple_msgs::Int> pub{publisher_address};
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, [&](const simple_msgs::Int& i) {
+      received_ints.push_back(i.get());
+      ++received_count;
+    }};
+    WHEN("The publisher waits for its subscriber") {
+      REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+      THEN("The subscriber has been welcomed and receives the very first message") {
+        REQUIRE(sub.waitForPublisher(std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+        REQUIRE(pub.publish(simple_msgs::Int{1}));
+        waitUntil([&] { return received_count.load() == 1; }, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+        REQUIRE(received_ints == std::vector<int>{1});
+      }
+      THEN("Waiting for more subscribers times out") {
+        REQUIRE_FALSE(pub.waitForSubscribers(2, std::chrono::milliseconds(100)));
+      }
+    }
+  }
+}
+
+SCENARIO("Monitor the connection of a subscriber to its publisher.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A monitored subscriber whose publisher is not running yet.") {
+    std::atomic<int> disconnections{0};
+    simple::Subscriber<simple_msgs::Int> sub{subscriber_address, [](const simple_msgs::Int&) {}};
+    sub.setMonitor([&](const simple::SocketEvent& event, const std::string& /*endpoint*/) {
+      if (event == simple::SocketEvent::disconnected) { ++disconnections; }
+    });
+    waitUntil([&] { return sub.eventCount(simple::SocketEvent::connect_retried) > 0; },
+              std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+    THEN("The connection attempts are retried") { REQUIRE(sub.eventCount(simple::SocketEvent::connect_retried) > 0); }
+    WHEN("The publisher starts and stops") {
+      {
+        simple::Publisher<simple_msgs::Int> pub{publisher_address};
+        REQUIRE(pub.waitForSubscribers(1, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+      }
+      waitUntil([&] { return sub.eventCount(simple::SocketEvent::disconnected) > 0 && disconnections.load() > 0; },
+                std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER));
+      THEN("The subscriber connected and noticed the loss of the publisher") {
+        REQUIRE(sub.eventCount(simple::SocketEvent::connected) == 1);
+        REQUIRE(sub.eventCount(simple::SocketEvent::disconnected) == 1);
+        REQUIRE(disconnections == 1);
+      }
+    }
+  }
+}
@@ -11,6 +11,17 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "simple/async_client.hpp"
 #include "simple/client.hpp"
 #include "simple/server.hpp"
 #include "test_utilities.hpp"
@@ -89,6 +100,112 @@ SCENARIO("Client-Server to a Int message.") {
   }
 }
 
+SCENARIO("Client-Server to a Int message with several workers.") {
+  const auto port = generatePort();
+  const auto server_address = "tcp://*:" + std::to_string(port);
+  const auto client_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A server with four workers and a slow callback.") {
+    const size_t num_workers = 4;
+    const auto callback_duration = std::chrono::milliseconds(200);
+    auto slow_callback = [callback_duration](simple_msgs::Int& i) {
+      std::this_thread::sleep_for(callback_duration);
+      i.set(i.get() + 1);
+    };
+    simple::Server<simple_msgs::Int> server(server_address, slow_callback, 1000, -1, num_workers);
+
+    WHEN("As many clients as workers send a request at the same time") {
+      std::vector<int> sent(num_workers), received(num_workers);
+      std::vector<std::thread> clients;
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t c = 0; c < num_workers; ++c) {
+        clients.emplace_back([&, c] {
+          simple::Client<simple_msgs::Int> client(client_address);
+          auto i = createRandomInt();
+          sent[c] = i.get();
+          if (client.request(i)) { received[c] = i.get(); }
+        });
+      }
+      for (auto& client : clients) { client.join(); }
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+
+      THEN("Every client receives its own data plus 1") {
+        for (size_t c = 0; c < num_workers; ++c) { REQUIRE(received[c] == sent[c] + 1); }
+      }
+      THEN("The requests are handled in parallel") {
+        REQUIRE(elapsed < callback_duration * num_workers);
+      }
+    }
+  }
+}
+
+SCENARIO("Client-Server to a Int message after a timeout.") {
+  const auto port = generatePort();
+  const auto server_address = "tcp://*:" + std::to_string(port);
+  const auto client_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("A server that is slow to answer the first request.") {
+    std::atomic<bool> first_request{true};
+    auto callback = [&first_request](simple_msgs::Int& i) {
+      if (first_request.exchange(false)) { std::this_thread::sleep_for(std::chrono::milliseconds(500)); }
+      i.set(i.get() + 1);
+    };
+    simple::Client<simple_msgs::Int> client(client_address);
+    simple::Server<simple_msgs::Int> server(server_address, callback);
+
+    WHEN("The first request times out and the client sends another one") {
+      auto first = createRandomInt();
+      auto first_success = client.request(first, 100);
+      auto second = createRandomInt();
+      auto sent = second.get();
+      auto second_success = client.request(second);
+
+      THEN("The first request fails") { REQUIRE(first_success == false); }
+      THEN("The second request receives its own reply, not the late one") {
+        REQUIRE(second_success);
+        REQUIRE(second.get() == sent + 1);
+      }
+    }
+  }
+}
+
+SCENARIO("AsyncClient-Server to a Int message.") {
+  const auto port = generatePort();
+  const auto server_address = "tcp://*:" + std::to_string(port);
+  const auto client_address = "tcp://localhost:" + std::to_string(port);
+  GIVEN("An AsyncClient and a server with several workers.") {
+    constexpr size_t num_requests = 100;
+    simple::AsyncClient<simple_msgs::Int> client(client_address);
+    simple::Server<simple_msgs::Int> server(server_address, callbackFunctionInt, 1000, -1, 4);
+
+    WHEN("The client sends many requests without waiting for the replies") {
+      std::vector<int> sent;
+      std::vector<std::future<simple_msgs::Int>> replies;
+      for (size_t r = 0; r < num_requests; ++r) {
+        auto i = createRandomInt();
+        sent.push_back(i.get());
+        replies.push_back(client.requestAsync(i));
+      }
+      THEN("Every reply matches its own request") {
+        for (size_t r = 0; r < num_requests; ++r) { REQUIRE(replies[r].get().get() == sent[r] + 1); }
+      }
+    }
+  }
+  GIVEN("An AsyncClient without a server.") {
+    simple::AsyncClient<simple_msgs::Int> client(client_address, 500, 0);
+    WHEN("The client sends a request") {
+      auto reply = client.requestAsync(createRandomInt());
+      THEN("The timeout is reached and the reply holds an exception") {
+        REQUIRE_THROWS_AS(reply.get(), std::runtime_error);
+      }
+    }
+  }
+  GIVEN("A default constructed AsyncClient.") {
+    simple::AsyncClient<simple_msgs::Int> client;
+    WHEN("Its endpoint is queried") {
+      THEN("It is empty") { REQUIRE(client.endpoint().empty()); }
+    }
+  }
+}
+
 SCENARIO("Client-Server to a Float message.") {
   const auto port = generatePort();
   const auto server_address = "tcp://*:" + std::to_string(port);
@@ -403,3 +520,139 @@ SCENARIO("Client-Server to a TransformStamped message.") {
     }
   }
 }
+
+SCENARIO("Client requests to several replicas of a Server.") {
+  constexpr int num_replicas = 3;
+  constexpr int num_requests = 30;
+  std::vector<std::string> client_addresses{};
+  std::vector<std::unique_ptr<simple::Server<simple_msgs::Int>>> replicas{};
+  GIVEN("Three replicas, each one adding its own offset to the request.") {
+    for (int r = 0; r < num_replicas; ++r) {
+      const auto port = generatePort();
+      client_addresses.push_back("tcp://localhost:" + std::to_string(port));
+      replicas.emplace_back(new simple::Server<simple_msgs::Int>(
+          "tcp://*:" + std::to_string(port), [r](simple_msgs::Int& i) { i.set(i.get() + 1000 * (r + 1)); }));
+    }
+    simple::Client<simple_msgs::Int> client(client_addresses, 2000, 0, 100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    WHEN("The client sends many requests") {
+      std::set<int> serving_replicas{};
+      for (int n = 0; n < num_requests; ++n) {
+        simple_msgs::Int i{n};
+        REQUIRE(client.request(i));
+        REQUIRE(i.get() % 1000 == n);
+        serving_replicas.insert(i.get() / 1000);
+      }
+      THEN("The requests are spread among all the replicas") { REQUIRE(serving_replicas.size() == num_replicas); }
+    }
+    WHEN("A replica stops") {
+      replicas.front().reset();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      THEN("Every request is answered by the other replicas") {
+        for (int n = 0; n < num_requests; ++n) {
+          simple_msgs::Int i{n};
+          REQUIRE(client.request(i));
+          REQUIRE(i.get() / 1000 != 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Client hedges its requests to several replicas of a Server.") {
+  constexpr int num_requests = 60;
+  const auto stall = std::chrono::milliseconds(300);
+  GIVEN("Two replicas, one of them stalling on a request out of four.") {
+    const auto slow_port = generatePort();
+    const auto fast_port = generatePort();
+    std::atomic<int> handled{0};
+    simple::Server<simple_msgs::Int> slow_server("tcp://*:" + std::to_string(slow_port), [&](simple_msgs::Int& i) {
+      if (++handled % 4 == 0) { std::this_thread::sleep_for(stall); }
+      i.set(i.get() + 1);
+    });
+    simple::Server<simple_msgs::Int> fast_server("tcp://*:" + std::to_string(fast_port),
+                                                 [](simple_msgs::Int& i) { i.set(i.get() + 1); });
+    std::vector<std::string> client_addresses{"tcp://localhost:" + std::to_string(slow_port),
+                                              "tcp://localhost:" + std::to_string(fast_port)};
+    simple::Client<simple_msgs::Int> client(client_addresses, 2000, 0, 100);
+
+    WHEN("The client hedges its requests") {
+      client.setHedging(90, 50);
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      auto slowest_request = std::chrono::steady_clock::duration::zero();
+      for (int n = 0; n < num_requests; ++n) {
+        simple_msgs::Int i{n};
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(client.request(i));
+        REQUIRE(i.get() == n + 1);
+        if (n >= 20) { slowest_request = std::max(slowest_request, std::chrono::steady_clock::now() - start); }
+      }
+      THEN("The stalls of a replica are hidden by the other one") {
+        REQUIRE(client.hedgedRequests() > 0);
+        REQUIRE(slowest_request < stall);
+      }
+    }
+    WHEN("The client is monitored") {
+      THEN("Hedging cannot be enabled once a monitor is set") {
+        client.setMonitor(nullptr);
+        REQUIRE_THROWS_AS(client.setHedging(), std::runtime_error);
+      }
+      THEN("A monitor set after enabling hedging is kept") {
+        client.setHedging(90, 50);
+        client.setMonitor(nullptr);
+        REQUIRE_NOTHROW(client.setHedging(95, 100));
+        simple_msgs::Int i{1};
+        REQUIRE(client.request(i));
+        REQUIRE(i.get() == 2);
+      }
+    }
+  }
+  GIVEN("A client connected to a single server.") {
+    simple::Client<simple_msgs::Int> client("tcp://localhost:" + std::to_string(generatePort()));
+    WHEN("It hedges its requests") {
+      THEN("An exception is thrown") { REQUIRE_THROWS_AS(client.setHedging(), std::runtime_error); }
+    }
+  }
+}
+
+SCENARIO("Client-Server to a Int message with deferred replies.") {
+  const auto port = generatePort();
+  const auto slow_request = 1000;
+  GIVEN("A Server replying to its requests from other threads.") {
+    std::mutex threads_mutex{};
+    std::vector<std::thread> reply_threads{};
+    {
+      simple::Server<simple_msgs::Int> server(
+          "tcp://*:" + std::to_string(port),
+          [&](simple_msgs::Int& i, simple::DeferredReply<simple_msgs::Int> reply) {
+            const auto value = i.get();
+            std::lock_guard<std::mutex> lock{threads_mutex};
+            reply_threads.emplace_back([value, reply] {
+              if (value == slow_request) { std::this_thread::sleep_for(std::chrono::milliseconds(500)); }
+              reply.send(simple_msgs::Int{value + 1});
+            });
+          });
+      simple::Client<simple_msgs::Int> slow_client("tcp://localhost:" + std::to_string(port));
+      simple::Client<simple_msgs::Int> fast_client("tcp://localhost:" + std::to_string(port));
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+      WHEN("A request is still being computed") {
+        auto slow_reply = std::async(std::launch::async, [&] {
+          simple_msgs::Int i{slow_request};
+          return slow_client.request(i) ? i.get() : -1;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        THEN("Further requests are replied meanwhile") {
+          simple_msgs::Int i{41};
+          auto start = std::chrono::steady_clock::now();
+          REQUIRE(fast_client.request(i));
+          REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(250));
+          REQUIRE(i.get() == 42);
+          REQUIRE(slow_reply.get() == slow_request + 1);
+        }
+      }
+    }
+    for (auto& reply_thread : reply_threads) { reply_thread.join(); }
+  }
+}
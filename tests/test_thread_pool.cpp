@@ -0,0 +1,92 @@
+/**
+ * S.I.M.P.L.E. - Smart Intuitive Messaging Platform with Less Effort
+ * Copyright (C) 2018 Salvatore Virga - salvo.virga@tum.de, Fernanda Levy
+ * Langsch - fernanda.langsch@tum.de
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "simple/publisher.hpp"
+#include "simple/subscriber.hpp"
+#include "simple/thread_pool.hpp"
+#include "test_utilities.hpp"
+
+using namespace simple_tests;
+
+// Test: Subscriber callbacks running on a shared ThreadPool.
+
+static constexpr size_t TEST_MESSAGES_TO_SEND = 20;
+static constexpr size_t WAIT_TIME_FOR_SUBSCRIBER = 2;  //! In seconds.
+static constexpr size_t TIME_BETWEEN_MESSAGES = 10;    //! In milliseconds.
+static constexpr size_t CALLBACK_DURATION = 50;        //! In milliseconds.
+
+SCENARIO("Subscribers running their callbacks on a ThreadPool.") {
+  const auto port = generatePort();
+  const auto publisher_address = "tcp://*:" + std::to_string(port);
+  const auto subscriber_address = "tcp://localhost:" + std::to_string(port);
+
+  GIVEN("A FIFO Subscriber and an unordered Subscriber with slow callbacks, sharing a ThreadPool.") {
+    simple::ThreadPool pool{4};
+    simple::Publisher<simple_msgs::Int> publisher{publisher_address};
+
+    std::mutex fifo_mutex;
+    std::vector<int> fifo_received;
+    std::atomic<size_t> fifo_running{0}, fifo_max_running{0};
+    auto fifo_callback = [&](const simple_msgs::Int& i) {
+      auto running = ++fifo_running;
+      if (running > fifo_max_running) { fifo_max_running = running; }
+      std::this_thread::sleep_for(std::chrono::milliseconds(CALLBACK_DURATION));
+      {
+        std::lock_guard<std::mutex> lock{fifo_mutex};
+        fifo_received.push_back(i.get());
+      }
+      --fifo_running;
+    };
+
+    std::atomic<size_t> unordered_received{0}, unordered_running{0}, unordered_max_running{0};
+    auto unordered_callback = [&](const simple_msgs::Int&) {
+      auto running = ++unordered_running;
+      if (running > unordered_max_running) { unordered_max_running = running; }
+      std::this_thread::sleep_for(std::chrono::milliseconds(CALLBACK_DURATION));
+      --unordered_running;
+      ++unordered_received;
+    };
+
+    simple::Subscriber<simple_msgs::Int> fifo_subscriber{subscriber_address, fifo_callback, pool,
+                                                         simple::CallbackOrder::fifo};
+    simple::Subscriber<simple_msgs::Int> unordered_subscriber{subscriber_address, unordered_callback, pool,
+                                                              simple::CallbackOrder::unordered};
+    REQUIRE(publisher.waitForSubscribers(2, std::chrono::seconds(WAIT_TIME_FOR_SUBSCRIBER)));
+
+    WHEN("The publisher sends messages faster than the callbacks run") {
+      for (size_t i = 0; i < TEST_MESSAGES_TO_SEND; ++i) {
+        publisher.publish(simple_msgs::Int{static_cast<int>(i)});
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME_BETWEEN_MESSAGES));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(CALLBACK_DURATION * TEST_MESSAGES_TO_SEND * 2));
+      fifo_subscriber.stop();
+      unordered_subscriber.stop();
+
+      THEN("The FIFO Subscriber runs one callback at a time, in the order of arrival") {
+        REQUIRE(fifo_received.size() == TEST_MESSAGES_TO_SEND);
+        for (size_t i = 0; i < fifo_received.size(); ++i) { REQUIRE(fifo_received[i] == static_cast<int>(i)); }
+        REQUIRE(fifo_max_running.load() == 1);
+      }
+      THEN("The unordered Subscriber runs its callbacks concurrently") {
+        REQUIRE(unordered_received.load() == TEST_MESSAGES_TO_SEND);
+        REQUIRE(unordered_max_running.load() > 1);
+      }
+    }
+  }
+}